@@ -0,0 +1,496 @@
+#include "HaxeGeneratorBenchmark.h"
+#include "HaxeReflectionBuilder.h"
+#include "HaxeGenerator.h"
+#include "HaxeFileSink.h"
+#include "IHaxeExternGenerator.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/Parse.h"
+
+using namespace HaxeGenerator;
+
+static const TCHAR *BenchModule = TEXT("UHXBenchmark");
+
+FHaxeBenchmarkConfig FHaxeBenchmarkConfig::fromCommandLine(const TCHAR *inCmdLine) {
+  FHaxeBenchmarkConfig ret;
+  FParse::Value(inCmdLine, TEXT("classes="), ret.numClasses);
+  FParse::Value(inCmdLine, TEXT("structs="), ret.numStructs);
+  FParse::Value(inCmdLine, TEXT("enums="), ret.numEnums);
+  FParse::Value(inCmdLine, TEXT("delegates="), ret.numDelegates);
+  FParse::Value(inCmdLine, TEXT("props="), ret.propsPerType);
+  FParse::Value(inCmdLine, TEXT("depth="), ret.inheritanceDepth);
+  FParse::Value(inCmdLine, TEXT("iterations="), ret.iterations);
+  if (!FParse::Value(inCmdLine, TEXT("out="), ret.outDir)) {
+    ret.outDir = FString(FPlatformProcess::UserTempDir()) / TEXT("UnrealHxBenchmark");
+  }
+
+  ret.numClasses = FMath::Max(ret.numClasses, 0);
+  ret.numStructs = FMath::Max(ret.numStructs, 0);
+  ret.numEnums = FMath::Max(ret.numEnums, 0);
+  ret.numDelegates = FMath::Max(ret.numDelegates, 0);
+  ret.propsPerType = FMath::Max(ret.propsPerType, 0);
+  ret.inheritanceDepth = FMath::Max(ret.inheritanceDepth, 1);
+  ret.iterations = FMath::Max(ret.iterations, 1);
+  return ret;
+}
+
+namespace {
+
+/**
+ * The kinds of properties that are added in turn to every synthetic type
+ **/
+enum class EBenchProp {
+  Int,
+  Float,
+  Bool,
+  String,
+  Name,
+  ByteEnum,
+  Enum,
+  Struct,
+  Object,
+  SubclassOf,
+  IntArray,
+  StructArray,
+  Map,
+  Delegate,
+
+  Num
+};
+
+struct FSyntheticModel {
+  UPackage *package;
+  TArray<UEnum *> enums;
+  TArray<UScriptStruct *> structs;
+  TArray<UFunction *> delegates;
+  TArray<UClass *> classes;
+  TArray<FString> headers;
+  // every property and function parameter. Inner properties of containers are not included
+  TArray<UProperty *> props;
+
+  FSyntheticModel() : package(nullptr)
+  {
+  }
+
+  int32 numTypes() const {
+    return enums.Num() + structs.Num() + delegates.Num() + classes.Num();
+  }
+};
+
+struct FPhaseResult {
+  FString name;
+  double seconds;
+  int64 items;
+  int64 bytes;
+};
+
+class FBenchmarkReport {
+private:
+  TArray<FPhaseResult> m_phases;
+
+public:
+  void add(const FString& inName, double inSeconds, int64 inItems, int64 inBytes=0) {
+    FPhaseResult result;
+    result.name = inName;
+    result.seconds = inSeconds;
+    result.items = inItems;
+    result.bytes = inBytes;
+    m_phases.Add(result);
+    UE_LOG(LogHaxeExtern, Display, TEXT("Benchmark: %s done in %.3fms"), *inName, inSeconds * 1000.0);
+  }
+
+  FString toString() const {
+    FString ret = FString::Printf(TEXT("%-28s %12s %12s %14s %10s\n"), TEXT("phase"), TEXT("ms"), TEXT("items"), TEXT("items/s"), TEXT("MB/s"));
+    for (const auto& phase : m_phases) {
+      double seconds = FMath::Max(phase.seconds, 1e-9);
+      ret += FString::Printf(TEXT("%-28s %12.3f %12lld %14.0f "), *phase.name, phase.seconds * 1000.0, phase.items, phase.items / seconds);
+      if (phase.bytes > 0) {
+        ret += FString::Printf(TEXT("%10.2f\n"), phase.bytes / (1024.0 * 1024.0) / seconds);
+      } else {
+        ret += TEXT("         -\n");
+      }
+    }
+    return ret;
+  }
+};
+
+}
+
+static UProperty *addBenchProperty(FSyntheticModel& inModel, UField *inOwner, const FString& inName, uint64 inFlags, int32 inKind, int32 inRef, int32 inNumStructs, bool inAllowDelegates) {
+  EBenchProp kind = (EBenchProp) (inKind % (int32) EBenchProp::Num);
+  // fall back to a basic type when the referenced kind of type doesn't exist (or can't be used here)
+  if (((kind == EBenchProp::ByteEnum || kind == EBenchProp::Enum) && inModel.enums.Num() == 0) ||
+      ((kind == EBenchProp::Struct || kind == EBenchProp::StructArray) && inNumStructs == 0) ||
+      (kind == EBenchProp::Delegate && (!inAllowDelegates || inModel.delegates.Num() == 0))) {
+    kind = EBenchProp::Int;
+  }
+
+  UClass *refClass = inModel.classes.Num() > 0 ? inModel.classes[inRef % inModel.classes.Num()] : UObject::StaticClass();
+  UProperty *ret = nullptr;
+  switch (kind) {
+  case EBenchProp::Int:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UIntProperty::StaticClass(), inName, inFlags);
+    break;
+  case EBenchProp::Float:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UFloatProperty::StaticClass(), inName, inFlags);
+    break;
+  case EBenchProp::Bool:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UBoolProperty::StaticClass(), inName, inFlags);
+    break;
+  case EBenchProp::String:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UStrProperty::StaticClass(), inName, inFlags);
+    break;
+  case EBenchProp::Name:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UNameProperty::StaticClass(), inName, inFlags);
+    break;
+  case EBenchProp::ByteEnum:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UByteProperty::StaticClass(), inName, inFlags);
+    FHaxeReflectionBuilder::setPropertyType(ret, inModel.enums[inRef % inModel.enums.Num()]);
+    break;
+  case EBenchProp::Enum:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UEnumProperty::StaticClass(), inName, inFlags);
+    FHaxeReflectionBuilder::setPropertyType(ret, inModel.enums[inRef % inModel.enums.Num()]);
+    break;
+  case EBenchProp::Struct:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UStructProperty::StaticClass(), inName, inFlags);
+    FHaxeReflectionBuilder::setPropertyType(ret, inModel.structs[inRef % inNumStructs]);
+    break;
+  case EBenchProp::Object:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UObjectProperty::StaticClass(), inName, inFlags);
+    FHaxeReflectionBuilder::setPropertyType(ret, refClass);
+    break;
+  case EBenchProp::SubclassOf:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UClassProperty::StaticClass(), inName, inFlags);
+    FHaxeReflectionBuilder::setPropertyType(ret, refClass);
+    break;
+  case EBenchProp::IntArray:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UArrayProperty::StaticClass(), inName, inFlags);
+    FHaxeReflectionBuilder::addProperty(ret, UIntProperty::StaticClass(), inName, 0);
+    break;
+  case EBenchProp::StructArray: {
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UArrayProperty::StaticClass(), inName, inFlags);
+    auto inner = FHaxeReflectionBuilder::addProperty(ret, UStructProperty::StaticClass(), inName, 0);
+    FHaxeReflectionBuilder::setPropertyType(inner, inModel.structs[inRef % inNumStructs]);
+    break;
+  }
+  case EBenchProp::Map:
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, UMapProperty::StaticClass(), inName, inFlags);
+    FHaxeReflectionBuilder::addProperty(ret, UStrProperty::StaticClass(), inName + TEXT("_Key"), 0);
+    FHaxeReflectionBuilder::addProperty(ret, UIntProperty::StaticClass(), inName + TEXT("_Value"), 0);
+    break;
+  case EBenchProp::Delegate: {
+    UFunction *signature = inModel.delegates[inRef % inModel.delegates.Num()];
+    UClass *propClass = (signature->FunctionFlags & FUNC_MulticastDelegate) != 0 ?
+      UMulticastDelegateProperty::StaticClass() :
+      UDelegateProperty::StaticClass();
+    ret = FHaxeReflectionBuilder::addProperty(inOwner, propClass, inName, inFlags);
+    FHaxeReflectionBuilder::setPropertyType(ret, signature);
+    break;
+  }
+  default:
+    check(false);
+  }
+
+  inModel.props.Add(ret);
+  return ret;
+}
+
+static void buildModel(const FHaxeBenchmarkConfig& inConfig, FSyntheticModel& outModel) {
+  outModel.package = FHaxeReflectionBuilder::createPackage(FString(TEXT("/Script/")) + BenchModule);
+  UPackage *pack = outModel.package;
+
+  TArray<FString> entries;
+  for (int32 i = 0; i < 8; i++) {
+    entries.Add(FString::Printf(TEXT("Value%d"), i));
+  }
+  for (int32 i = 0; i < inConfig.numEnums; i++) {
+    auto uenum = FHaxeReflectionBuilder::createEnum(pack, FString::Printf(TEXT("EBenchEnum%d"), i), entries,
+        (i % 2) == 0 ? UEnum::ECppForm::EnumClass : UEnum::ECppForm::Namespaced);
+    FHaxeReflectionBuilder::setMetaData(uenum, TEXT("ToolTip"), FString::Printf(TEXT("Synthetic enum %d"), i));
+    outModel.enums.Add(uenum);
+  }
+
+  // create all types first so that they can reference each other
+  for (int32 i = 0; i < inConfig.numStructs; i++) {
+    auto ustruct = FHaxeReflectionBuilder::createStruct(pack, FString::Printf(TEXT("BenchStruct%d"), i), nullptr, STRUCT_RequiredAPI);
+    FHaxeReflectionBuilder::setMetaData(ustruct, TEXT("ToolTip"), FString::Printf(TEXT("Synthetic struct %d\nwith a multiline comment"), i));
+    outModel.structs.Add(ustruct);
+  }
+  for (int32 i = 0; i < inConfig.numClasses; i++) {
+    UClass *super = (i % inConfig.inheritanceDepth) == 0 ? nullptr : outModel.classes[i - 1];
+    auto uclass = FHaxeReflectionBuilder::createClass(pack, FString::Printf(TEXT("BenchObject%d"), i), super, CLASS_RequiredAPI);
+    FHaxeReflectionBuilder::setMetaData(uclass, TEXT("ToolTip"), FString::Printf(TEXT("Synthetic class %d"), i));
+    outModel.classes.Add(uclass);
+    outModel.headers.Add(FString::Printf(TEXT("/Engine/Plugins/%s/Source/%s/Public/Bench/BenchObject%d.h"), BenchModule, BenchModule, i));
+  }
+  for (int32 i = 0; i < inConfig.numDelegates; i++) {
+    auto udelegate = FHaxeReflectionBuilder::createDelegate(pack, FString::Printf(TEXT("BenchDelegate%d"), i), (i % 2) == 0);
+    outModel.delegates.Add(udelegate);
+  }
+
+  int32 numStructs = outModel.structs.Num();
+  for (int32 i = 0; i < outModel.delegates.Num(); i++) {
+    auto udelegate = outModel.delegates[i];
+    for (int32 p = 0; p < 2; p++) {
+      addBenchProperty(outModel, udelegate, FString::Printf(TEXT("Param%d"), p), CPF_Parm, i + p, i + p, numStructs, false);
+    }
+    FHaxeReflectionBuilder::finish(udelegate);
+  }
+
+  // structs only reference the structs created before them, so they can be linked in order
+  for (int32 i = 0; i < numStructs; i++) {
+    auto ustruct = outModel.structs[i];
+    for (int32 p = 0; p < inConfig.propsPerType; p++) {
+      auto prop = addBenchProperty(outModel, ustruct, FString::Printf(TEXT("Field%d"), p), CPF_Edit | CPF_BlueprintVisible, i + p, i * 7 + p, i, false);
+      FHaxeReflectionBuilder::setMetaData(prop, TEXT("ToolTip"), FString::Printf(TEXT("Field %d of struct %d"), p, i));
+    }
+    FHaxeReflectionBuilder::finish(ustruct);
+  }
+
+  // classes are linked after their superclasses
+  int32 numFuncs = FMath::Max(inConfig.propsPerType / 4, 1);
+  for (int32 i = 0; i < outModel.classes.Num(); i++) {
+    auto uclass = outModel.classes[i];
+    for (int32 p = 0; p < inConfig.propsPerType; p++) {
+      auto prop = addBenchProperty(outModel, uclass, FString::Printf(TEXT("Prop%d_%d"), i, p), CPF_Edit | CPF_BlueprintVisible, i + p, i * 13 + p, numStructs, true);
+      FHaxeReflectionBuilder::setMetaData(prop, TEXT("ToolTip"), FString::Printf(TEXT("Property %d of class %d"), p, i));
+    }
+    for (int32 f = 0; f < numFuncs; f++) {
+      auto ufunc = FHaxeReflectionBuilder::createFunction(uclass, FString::Printf(TEXT("Func%d_%d"), i, f), FUNC_Public | FUNC_BlueprintCallable);
+      for (int32 p = 0; p < 3; p++) {
+        addBenchProperty(outModel, ufunc, FString::Printf(TEXT("Arg%d"), p), CPF_Parm, i + f + p, i + f * 3 + p, numStructs, false);
+      }
+      addBenchProperty(outModel, ufunc, TEXT("ReturnValue"), CPF_Parm | CPF_ReturnParm | CPF_OutParm, i + f, i + f, numStructs, false);
+      FHaxeReflectionBuilder::setMetaData(ufunc, TEXT("ToolTip"), FString::Printf(TEXT("Function %d of class %d"), f, i));
+      FHaxeReflectionBuilder::finish(ufunc);
+    }
+    FHaxeReflectionBuilder::finish(uclass);
+  }
+}
+
+static bool generateEntry(FHaxeGenerator& inGen, const FHaxeTypeEntry& inEntry) {
+  switch (inEntry.kind) {
+  case ETypeKind::KUStruct:
+    return inGen.generateStruct(inEntry.ustruct);
+  case ETypeKind::KUEnum:
+    return inGen.generateEnum(inEntry.uenum);
+  case ETypeKind::KUDelegate:
+    return inGen.generateDelegate(inEntry.udelegate);
+  default:
+    return inGen.generateClass(inEntry.cls);
+  }
+}
+
+int32 FHaxeGeneratorBenchmark::run(const FHaxeBenchmarkConfig& inConfig) {
+  FBenchmarkReport report;
+  auto& fileMan = IFileManager::Get();
+  FString componentsDir = inConfig.outDir / TEXT("Components");
+  FString endToEndDir = inConfig.outDir / TEXT("EndToEnd");
+  fileMan.MakeDirectory(*componentsDir, true);
+  fileMan.MakeDirectory(*endToEndDir, true);
+
+  FSyntheticModel model;
+  double start = FPlatformTime::Seconds();
+  buildModel(inConfig, model);
+  report.add(TEXT("build model"), FPlatformTime::Seconds() - start, model.numTypes());
+
+  // pipeline phases, called directly
+  FHaxeTypes types(componentsDir);
+  start = FPlatformTime::Seconds();
+  for (int32 i = 0; i < model.classes.Num(); i++) {
+    types.touchClass(model.classes[i], model.headers[i], BenchModule);
+  }
+  report.add(TEXT("touch classes"), FPlatformTime::Seconds() - start, model.classes.Num());
+
+  start = FPlatformTime::Seconds();
+  for (auto ustruct : model.structs) {
+    types.touchStruct(ustruct, nullptr);
+  }
+  for (auto uenum : model.enums) {
+    types.touchEnum(uenum, nullptr);
+  }
+  for (auto udelegate : model.delegates) {
+    types.touchDelegate(udelegate, nullptr);
+  }
+  report.add(TEXT("touch sweep"), FPlatformTime::Seconds() - start, model.structs.Num() + model.enums.Num() + model.delegates.Num());
+
+  int32 numTypes = types.getNumTypes();
+  TArray<FString> contents;
+  contents.SetNum(numTypes);
+  {
+    FHaxeTypeStringCache typeStrings;
+    FHaxeGenerator gen(types, &typeStrings);
+    int64 bytes = 0;
+    int32 generated = 0;
+    start = FPlatformTime::Seconds();
+    for (int32 id = 0; id < numTypes; id++) {
+      auto& entry = types.getType(id);
+      if (entry.exported && generateEntry(gen, entry)) {
+        gen.copyTo(contents[id]);
+        bytes += contents[id].Len();
+        generated++;
+      }
+      gen.reset();
+    }
+    report.add(TEXT("generate (serial)"), FPlatformTime::Seconds() - start, generated, bytes);
+  }
+
+  {
+    FHaxeTypeStringCache typeStrings;
+    FHaxeGeneratorPool pool(types, &typeStrings);
+    TArray<FString> parallelContents;
+    parallelContents.SetNum(numTypes);
+    start = FPlatformTime::Seconds();
+    ParallelFor(numTypes, [&](int32 id) {
+      auto& entry = types.getType(id);
+      if (!entry.exported) {
+        return;
+      }
+      auto gen = pool.acquire();
+      if (generateEntry(*gen, entry)) {
+        gen->copyTo(parallelContents[id]);
+      }
+      pool.release(gen);
+    });
+    double seconds = FPlatformTime::Seconds() - start;
+    int64 bytes = 0;
+    int32 generated = 0;
+    for (auto& text : parallelContents) {
+      if (!text.IsEmpty()) {
+        bytes += text.Len();
+        generated++;
+      }
+    }
+    report.add(TEXT("generate (parallel)"), seconds, generated, bytes);
+  }
+
+  {
+    TSet<FString> createdDirs;
+    int64 bytes = 0;
+    int32 written = 0;
+    start = FPlatformTime::Seconds();
+    for (int32 id = 0; id < numTypes; id++) {
+      if (contents[id].IsEmpty()) {
+        continue;
+      }
+      auto& haxeType = types.getType(id).getHaxeType();
+      FString dir = componentsDir / haxeType.getPackagePath();
+      if (!createdDirs.Contains(dir)) {
+        fileMan.MakeDirectory(*dir, true);
+        createdDirs.Add(dir);
+      }
+      FHaxeFileSink sink;
+      if (!sink.open(dir / haxeType.getName() + TEXT(".hx"))) {
+        UE_LOG(LogHaxeExtern, Error, TEXT("Cannot write file at path %s"), *(dir / haxeType.getName()));
+        return 1;
+      }
+      sink.write(contents[id]);
+      if (!sink.commit()) {
+        UE_LOG(LogHaxeExtern, Error, TEXT("Cannot write file at path %s"), *(dir / haxeType.getName()));
+        return 1;
+      }
+      bytes += contents[id].Len();
+      written++;
+    }
+    report.add(TEXT("write files"), FPlatformTime::Seconds() - start, written, bytes);
+  }
+
+  // micro-benchmarks
+  {
+    static const Comment propComment(TEXT("A synthetic property\nwith a comment that spans\nthree lines"));
+    static const FString propLine = TEXT("public var someProperty : unreal.TArray<unreal.FString>;");
+    FHelperBuf buf;
+    int64 bytes = 0;
+    start = FPlatformTime::Seconds();
+    for (int32 i = 0; i < inConfig.iterations; i++) {
+      buf.reset();
+      buf << TEXT("@:glueCppIncludes(\"Bench/BenchObject.h\")") << Newline();
+      buf << TEXT("@:uextern @:uclass extern class UBenchObject extends unreal.UObject ") << Begin();
+      for (int32 p = 0; p < 8; p++) {
+        buf << propComment << propLine << Newline();
+      }
+      buf << End();
+      bytes += buf.toString().Len();
+    }
+    report.add(TEXT("FHelperBuf"), FPlatformTime::Seconds() - start, inConfig.iterations, bytes);
+  }
+
+  {
+    static const TCHAR *paths[] = {
+      TEXT("/home/build/UE4/Engine/Source/Runtime/Engine/Classes/GameFramework/Actor.h"),
+      TEXT("/home/build/UE4/Engine/Source/Runtime/UMG/Public/Components/Widget.h"),
+      TEXT("C:\\UE4\\Engine\\Plugins\\UHXBenchmark\\Source\\UHXBenchmark\\Private\\BenchObject.h"),
+      TEXT("/home/build/Game/Source/UHXBenchmark/BenchObject.h"),
+      TEXT("Bench/BenchObject.h"),
+    };
+    int32 numPaths = ARRAY_COUNT(paths);
+    TArray<FString> pathStrings;
+    for (int32 i = 0; i < numPaths; i++) {
+      pathStrings.Add(paths[i]);
+    }
+    int64 total = 0;
+    start = FPlatformTime::Seconds();
+    for (int32 i = 0; i < inConfig.iterations; i++) {
+      total += FHaxeGenerator::getHeaderPath(model.package, pathStrings[i % numPaths]).Len();
+    }
+    report.add(TEXT("getHeaderPath"), FPlatformTime::Seconds() - start, inConfig.iterations);
+    // make sure the calls above are not optimized away
+    UE_LOG(LogHaxeExtern, Verbose, TEXT("getHeaderPath checksum: %lld"), total);
+  }
+
+  if (model.props.Num() > 0) {
+    int32 calls = FMath::Max(inConfig.iterations, model.props.Num());
+    FHaxeTypeStringCache typeStrings;
+    FHaxeGenerator uncached(types);
+    FHaxeGenerator cached(types, &typeStrings);
+    FString type;
+    start = FPlatformTime::Seconds();
+    for (int32 i = 0; i < calls; i++) {
+      type.Reset();
+      uncached.resolvePropertyType(model.props[i % model.props.Num()], type);
+    }
+    report.add(TEXT("upropType (uncached)"), FPlatformTime::Seconds() - start, calls);
+
+    start = FPlatformTime::Seconds();
+    for (int32 i = 0; i < calls; i++) {
+      type.Reset();
+      cached.resolvePropertyType(model.props[i % model.props.Num()], type);
+    }
+    report.add(TEXT("upropType (cached)"), FPlatformTime::Seconds() - start, calls);
+  }
+
+  // the whole plugin, exactly as UHT would drive it
+  {
+    FPlatformMisc::SetEnvironmentVar(TEXT("EXTERN_OUTPUT_DIR"), *endToEndDir);
+    FPlatformMisc::SetEnvironmentVar(TEXT("EXTERN_FULL_OUT_PATH"), TEXT(""));
+    auto& plugin = FModuleManager::LoadModuleChecked<IHaxeExternGenerator>(TEXT("UnrealHxGenerator"));
+    plugin.Initialize(inConfig.outDir, inConfig.outDir, inConfig.outDir, inConfig.outDir);
+    plugin.ShouldExportClassesForModule(BenchModule, EBuildModuleType::EngineRuntime, inConfig.outDir);
+
+    start = FPlatformTime::Seconds();
+    for (int32 i = 0; i < model.classes.Num(); i++) {
+      plugin.ExportClass(model.classes[i], model.headers[i], FString(), true);
+    }
+    report.add(TEXT("plugin ExportClass"), FPlatformTime::Seconds() - start, model.classes.Num());
+
+    start = FPlatformTime::Seconds();
+    plugin.FinishExport();
+    report.add(TEXT("plugin FinishExport"), FPlatformTime::Seconds() - start, model.numTypes());
+  }
+
+  FString header = FString::Printf(
+      TEXT("UnrealHxGenerator benchmark: %d classes (depth %d), %d structs, %d enums, %d delegates, %d properties per type, %d iterations\n"),
+      inConfig.numClasses, inConfig.inheritanceDepth, inConfig.numStructs, inConfig.numEnums, inConfig.numDelegates,
+      inConfig.propsPerType, inConfig.iterations);
+  FString text = header + report.toString();
+  UE_LOG(LogHaxeExtern, Display, TEXT("\n%s"), *text);
+  FString reportPath = inConfig.outDir / TEXT("benchmark.txt");
+  if (!FFileHelper::SaveStringToFile(text, *reportPath)) {
+    UE_LOG(LogHaxeExtern, Error, TEXT("Cannot write benchmark report at path %s"), *reportPath);
+    return 1;
+  }
+  return 0;
+}
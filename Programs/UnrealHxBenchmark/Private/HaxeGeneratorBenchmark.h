@@ -0,0 +1,51 @@
+#pragma once
+#include <CoreUObject.h>
+
+/**
+ * The shape of the synthetic reflection model used by the benchmark
+ **/
+struct FHaxeBenchmarkConfig {
+  int32 numClasses;
+  int32 numStructs;
+  int32 numEnums;
+  int32 numDelegates;
+  int32 propsPerType;
+  // how many classes are chained together before starting again from UObject
+  int32 inheritanceDepth;
+  // how many times each micro-benchmark runs
+  int32 iterations;
+  // where the generated files and the report are written
+  FString outDir;
+
+  FHaxeBenchmarkConfig() :
+    numClasses(2000),
+    numStructs(1000),
+    numEnums(500),
+    numDelegates(500),
+    propsPerType(16),
+    inheritanceDepth(6),
+    iterations(100000)
+  {
+  }
+
+  /**
+   * Reads the options from a command line, e.g. `-classes=2000 -structs=1000 -enums=500 -delegates=500
+   * -props=16 -depth=6 -iterations=100000 -out=/tmp/uhxbench`
+   **/
+  static FHaxeBenchmarkConfig fromCommandLine(const TCHAR *inCmdLine);
+};
+
+/**
+ * Measures the generator without a UHT run: it builds a synthetic reflection model with `FHaxeReflectionBuilder`,
+ * times each phase of the pipeline (touch, generation and file output) and a few hot functions on their own,
+ * and then runs the whole plugin (`Initialize`, `ExportClass` and `FinishExport`) over the same model.
+ *
+ * The whole plugin can only run once per process, as its type information is never cleared
+ **/
+class FHaxeGeneratorBenchmark {
+public:
+  /**
+   * Runs the benchmark, prints a report and saves it to `outDir/benchmark.txt`. Returns the process exit code
+   **/
+  static int32 run(const FHaxeBenchmarkConfig& inConfig);
+};
@@ -0,0 +1,14 @@
+#include "RequiredProgramMainCPPInclude.h"
+#include "HaxeGeneratorBenchmark.h"
+
+IMPLEMENT_APPLICATION(UnrealHxBenchmark, "UnrealHxBenchmark");
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV() {
+  GEngineLoop.PreInit(ArgC, ArgV);
+  int32 ret = FHaxeGeneratorBenchmark::run(FHaxeBenchmarkConfig::fromCommandLine(FCommandLine::Get()));
+
+  FEngineLoop::AppPreExit();
+  FModuleManager::Get().UnloadModulesAtShutdown();
+  FEngineLoop::AppExit();
+  return ret;
+}
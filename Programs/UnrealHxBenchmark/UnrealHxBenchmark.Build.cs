@@ -0,0 +1,18 @@
+using UnrealBuildTool;
+
+public class UnrealHxBenchmark : ModuleRules {
+  public UnrealHxBenchmark(ReadOnlyTargetRules target) : base(target) {
+    PublicIncludePaths.Add("Runtime/Launch/Public");
+    PrivateIncludePaths.Add("Runtime/Launch/Private");
+    PrivateDependencyModuleNames.AddRange(
+      new string[]
+      {
+        "Core",
+        "CoreUObject",
+        "Projects",
+        "UnrealHxGenerator",
+        "UnrealHxGeneratorDev",
+      }
+    );
+  }
+}
@@ -0,0 +1,19 @@
+using UnrealBuildTool;
+
+[SupportedPlatforms(UnrealPlatformClass.Desktop)]
+public class UnrealHxBenchmarkTarget : TargetRules {
+  public UnrealHxBenchmarkTarget(TargetInfo target) : base(target) {
+    Type = TargetType.Program;
+    LinkType = TargetLinkType.Monolithic;
+    LaunchModuleName = "UnrealHxBenchmark";
+
+    bCompileLeanAndMeanUE = true;
+    bCompileAgainstEngine = false;
+    bCompileAgainstCoreUObject = true;
+    // the generator reads the reflection metadata, which only exists with editor-only data
+    bBuildWithEditorOnlyData = true;
+    bBuildDeveloperTools = false;
+    bCompileICU = false;
+    bIsBuildingConsoleApplication = true;
+  }
+}
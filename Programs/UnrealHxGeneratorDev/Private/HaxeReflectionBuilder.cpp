@@ -0,0 +1,135 @@
+#include "HaxeReflectionBuilder.h"
+#include "HaxeTypes.h"
+
+// appends `inField` to the end of the children of `inOwner`, so that `TFieldIterator` sees the fields in the order
+// they were added (just like the ones that come from a parsed header)
+static void appendChild(UStruct *inOwner, UField *inField) {
+  UField **link = &inOwner->Children;
+  while (*link != nullptr) {
+    link = &(*link)->Next;
+  }
+  *link = inField;
+}
+
+UPackage *FHaxeReflectionBuilder::createPackage(const FString& inName) {
+  UPackage *ret = CreatePackage(nullptr, *inName);
+  ret->SetPackageFlags(PKG_CompiledIn);
+  return ret;
+}
+
+UClass *FHaxeReflectionBuilder::createClass(UPackage *inPackage, const FString& inName, UClass *inSuper, uint32 inClassFlags) {
+  if (inSuper == nullptr) {
+    inSuper = UObject::StaticClass();
+  }
+  UClass *ret = NewObject<UClass>(inPackage, FName(*inName), RF_Public | RF_Standalone);
+  ret->SetSuperStruct(inSuper);
+  ret->ClassFlags |= (EClassFlags) (inClassFlags | CLASS_Native);
+  ret->ClassWithin = inSuper->ClassWithin;
+  ret->ClassConfigName = inSuper->ClassConfigName;
+  return ret;
+}
+
+UScriptStruct *FHaxeReflectionBuilder::createStruct(UPackage *inPackage, const FString& inName, UScriptStruct *inSuper, uint32 inStructFlags) {
+  UScriptStruct *ret = NewObject<UScriptStruct>(inPackage, FName(*inName), RF_Public | RF_Standalone);
+  ret->SetSuperStruct(inSuper);
+  ret->StructFlags = (EStructFlags) (ret->StructFlags | inStructFlags);
+  return ret;
+}
+
+UEnum *FHaxeReflectionBuilder::createEnum(UPackage *inPackage, const FString& inName, const TArray<FString>& inEntries, UEnum::ECppForm inForm) {
+  TArray<TPair<FName, int64>> names;
+  names.Reserve(inEntries.Num());
+  for (int32 i = 0; i < inEntries.Num(); i++) {
+    if (inForm == UEnum::ECppForm::Regular) {
+      names.Emplace(FName(*inEntries[i]), i);
+    } else {
+      names.Emplace(FName(*(inName + TEXT("::") + inEntries[i])), i);
+    }
+  }
+  return createEnum(inPackage, inName, names, inForm, inName);
+}
+
+UEnum *FHaxeReflectionBuilder::createEnum(UPackage *inPackage, const FString& inName, const TArray<TPair<FName, int64>>& inEntries, UEnum::ECppForm inForm, const FString& inCppType) {
+  UEnum *ret = NewObject<UEnum>(inPackage, FName(*inName), RF_Public | RF_Standalone);
+  // `SetEnums` may add the `_MAX` entry to the array it gets
+  TArray<TPair<FName, int64>> names = inEntries;
+  ret->SetEnums(names, inForm, true);
+  ret->CppType = inCppType;
+  return ret;
+}
+
+UFunction *FHaxeReflectionBuilder::createDelegate(UObject *inOuter, const FString& inName, bool inMulticast) {
+  UFunction *ret = NewObject<UFunction>(inOuter, FName(*(inName + TEXT("__DelegateSignature"))), RF_Public | RF_Standalone);
+  ret->FunctionFlags |= FUNC_Public | FUNC_Delegate;
+  if (inMulticast) {
+    ret->FunctionFlags |= FUNC_MulticastDelegate;
+  }
+  if (UStruct *owner = Cast<UStruct>(inOuter)) {
+    appendChild(owner, ret);
+  }
+  return ret;
+}
+
+UFunction *FHaxeReflectionBuilder::createFunction(UClass *inOwner, const FString& inName, uint32 inFunctionFlags) {
+  UFunction *ret = NewObject<UFunction>(inOwner, FName(*inName), RF_Public);
+  ret->FunctionFlags |= (EFunctionFlags) (inFunctionFlags | FUNC_Native);
+  appendChild(inOwner, ret);
+  return ret;
+}
+
+void FHaxeReflectionBuilder::addInterface(UClass *inClass, UClass *inInterface) {
+  inClass->Interfaces.Add(FImplementedInterface(inInterface, 0, false));
+}
+
+UProperty *FHaxeReflectionBuilder::addProperty(UField *inOwner, UClass *inPropClass, const FString& inName, uint64 inPropFlags) {
+  check(inPropClass->IsChildOf(UProperty::StaticClass()));
+  UProperty *ret = NewObject<UProperty>(inOwner, inPropClass, FName(*inName), RF_Public);
+  ret->SetPropertyFlags(inPropFlags);
+  if (UBoolProperty *boolProp = Cast<UBoolProperty>(ret)) {
+    boolProp->SetBoolSize(sizeof(bool), true);
+  }
+  if (UStruct *owner = Cast<UStruct>(inOwner)) {
+    appendChild(owner, ret);
+  } else {
+    // containers (and enum properties) know where to put their inner properties
+    inOwner->AddCppProperty(ret);
+  }
+  return ret;
+}
+
+void FHaxeReflectionBuilder::setPropertyType(UProperty *inProp, UObject *inType) {
+  if (UStructProperty *structProp = Cast<UStructProperty>(inProp)) {
+    structProp->Struct = CastChecked<UScriptStruct>(inType);
+  } else if (UClassProperty *classProp = Cast<UClassProperty>(inProp)) {
+    classProp->PropertyClass = UClass::StaticClass();
+    classProp->MetaClass = CastChecked<UClass>(inType);
+  } else if (UObjectPropertyBase *objProp = Cast<UObjectPropertyBase>(inProp)) {
+    objProp->PropertyClass = CastChecked<UClass>(inType);
+  } else if (UInterfaceProperty *interfaceProp = Cast<UInterfaceProperty>(inProp)) {
+    interfaceProp->InterfaceClass = CastChecked<UClass>(inType);
+  } else if (UByteProperty *byteProp = Cast<UByteProperty>(inProp)) {
+    byteProp->Enum = CastChecked<UEnum>(inType);
+  } else if (UEnumProperty *enumProp = Cast<UEnumProperty>(inProp)) {
+    enumProp->SetEnum(CastChecked<UEnum>(inType));
+    if (enumProp->GetUnderlyingProperty() == nullptr) {
+      addProperty(enumProp, UByteProperty::StaticClass(), TEXT("UnderlyingType"), 0);
+    }
+  } else if (UDelegateProperty *delegateProp = Cast<UDelegateProperty>(inProp)) {
+    delegateProp->SignatureFunction = CastChecked<UFunction>(inType);
+  } else if (UMulticastDelegateProperty *multicastProp = Cast<UMulticastDelegateProperty>(inProp)) {
+    multicastProp->SignatureFunction = CastChecked<UFunction>(inType);
+  } else {
+    UE_LOG(LogHaxeExtern, Fatal, TEXT("Property %s (%s) does not reference any type"), *inProp->GetName(), *inProp->GetClass()->GetName());
+  }
+}
+
+void FHaxeReflectionBuilder::setMetaData(UField *inField, const FString& inKey, const FString& inValue) {
+  inField->SetMetaData(*inKey, *inValue);
+}
+
+void FHaxeReflectionBuilder::finish(UStruct *inStruct) {
+  if (UClass *cls = Cast<UClass>(inStruct)) {
+    cls->Bind();
+  }
+  inStruct->StaticLink(true);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <CoreUObject.h>
+
+/**
+ * Creates reflection data (packages, classes, structs, enums, delegate signatures and their properties)
+ * at runtime, the same way UHT creates it while parsing headers.
+ * This lets us feed the generator with types that don't come from a UHT run (e.g. in the benchmark or the replay)
+ *
+ * Properties are added to their owner (a struct, a function, or a container property) in declaration order.
+ * `finish` must be called on every struct, class and function after all their fields were added
+ **/
+class FHaxeReflectionBuilder {
+public:
+  static UPackage *createPackage(const FString& inName);
+
+  static UClass *createClass(UPackage *inPackage, const FString& inName, UClass *inSuper, uint32 inClassFlags);
+
+  static UScriptStruct *createStruct(UPackage *inPackage, const FString& inName, UScriptStruct *inSuper, uint32 inStructFlags);
+
+  static UEnum *createEnum(UPackage *inPackage, const FString& inName, const TArray<FString>& inEntries, UEnum::ECppForm inForm);
+
+  /**
+   * Creates an enum with the given entries and values. The entry names must already be qualified
+   * (e.g. `EMyEnum::Value`) if the enum is not a regular C++ enum
+   **/
+  static UEnum *createEnum(UPackage *inPackage, const FString& inName, const TArray<TPair<FName, int64>>& inEntries, UEnum::ECppForm inForm, const FString& inCppType);
+
+  /**
+   * Creates a delegate signature. `inName` should not include the `__DelegateSignature` suffix
+   **/
+  static UFunction *createDelegate(UObject *inOuter, const FString& inName, bool inMulticast);
+
+  static UFunction *createFunction(UClass *inOwner, const FString& inName, uint32 inFunctionFlags);
+
+  static void addInterface(UClass *inClass, UClass *inInterface);
+
+  /**
+   * Creates a property of class `inPropClass` and adds it to `inOwner`, which may be a struct, a class,
+   * a function or a container property (array, map, set or enum property)
+   **/
+  static UProperty *addProperty(UField *inOwner, UClass *inPropClass, const FString& inName, uint64 inPropFlags);
+
+  /**
+   * Sets the type referenced by `inProp`: the struct of a struct property, the class of an object property,
+   * the interface of an interface property, the enum of a byte or enum property, or the signature of a delegate property
+   **/
+  static void setPropertyType(UProperty *inProp, UObject *inType);
+
+  static void setMetaData(UField *inField, const FString& inKey, const FString& inValue);
+
+  /**
+   * Links `inStruct` after all its fields were added
+   **/
+  static void finish(UStruct *inStruct);
+};
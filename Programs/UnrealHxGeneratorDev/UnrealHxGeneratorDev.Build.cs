@@ -0,0 +1,21 @@
+using UnrealBuildTool;
+
+// tools shared by the programs that drive the generator without UHT (the benchmark and the replay).
+// It's only linked into monolithic programs, so it doesn't export anything
+public class UnrealHxGeneratorDev : ModuleRules {
+  public UnrealHxGeneratorDev(ReadOnlyTargetRules target) : base(target) {
+    PublicDependencyModuleNames.AddRange(
+      new string[]
+      {
+        "Core",
+        "CoreUObject",
+      }
+    );
+    PrivateDependencyModuleNames.AddRange(
+      new string[]
+      {
+        "UnrealHxGenerator",
+      }
+    );
+  }
+}
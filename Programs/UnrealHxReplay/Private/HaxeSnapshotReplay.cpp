@@ -0,0 +1,240 @@
+#include "HaxeSnapshotReplay.h"
+#include "HaxeReflectionBuilder.h"
+#include "IHaxeExternGenerator.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+
+static void setMetaData(UField *inField, const TArray<FString>& inKeys, const TArray<FString>& inValues) {
+  for (int32 i = 0; i < inKeys.Num(); i++) {
+    FHaxeReflectionBuilder::setMetaData(inField, inKeys[i], inValues[i]);
+  }
+}
+
+static UObject *findObject(const TMap<FString, UObject *>& inObjects, const FString& inPath) {
+  UObject *ret = inObjects.FindRef(inPath);
+  if (ret == nullptr) {
+    // types that weren't in the snapshot may still be compiled in (e.g. the ones in CoreUObject)
+    ret = FindObject<UObject>(nullptr, *inPath);
+  }
+  if (ret == nullptr) {
+    UE_LOG(LogHaxeExtern, Fatal, TEXT("The snapshot references %s, which was not found"), *inPath);
+  }
+  return ret;
+}
+
+/**
+ * Relinks the children of `inStruct` in the order they were declared, as the functions and delegates
+ * were added before the properties
+ **/
+static void relinkChildren(UStruct *inStruct, const TArray<FString>& inOrder) {
+  TMap<FString, UField *> byName;
+  for (UField *field = inStruct->Children; field != nullptr; field = field->Next) {
+    byName.Add(field->GetName(), field);
+  }
+  UField **link = &inStruct->Children;
+  for (auto& name : inOrder) {
+    UField *field = byName.FindRef(name);
+    if (field != nullptr) {
+      *link = field;
+      link = &field->Next;
+    }
+  }
+  *link = nullptr;
+}
+
+static void finishWithSupers(UStruct *inStruct, const TSet<UStruct *>& inCreated, TSet<UStruct *>& refFinished) {
+  if (refFinished.Contains(inStruct)) {
+    return;
+  }
+  refFinished.Add(inStruct);
+  UStruct *super = inStruct->GetSuperStruct();
+  if (super != nullptr && inCreated.Contains(super)) {
+    finishWithSupers(super, inCreated, refFinished);
+  }
+  FHaxeReflectionBuilder::finish(inStruct);
+}
+
+bool FHaxeSnapshotReplay::load(const FString& inPath) {
+  m_types.Reset();
+  m_exports.Reset();
+  TArray<uint8> data;
+  if (!FFileHelper::LoadFileToArray(data, *inPath)) {
+    UE_LOG(LogHaxeExtern, Error, TEXT("Cannot read reflection snapshot at path %s"), *inPath);
+    return false;
+  }
+  FMemoryReader reader(data);
+  uint32 magic = 0;
+  int32 version = 0;
+  reader << magic;
+  reader << version;
+  if (magic != HAXE_SNAPSHOT_MAGIC || version != HAXE_SNAPSHOT_VERSION) {
+    UE_LOG(LogHaxeExtern, Error, TEXT("%s is not a reflection snapshot of this version of the generator"), *inPath);
+    return false;
+  }
+  reader << m_types;
+  reader << m_exports;
+  if (reader.IsError()) {
+    UE_LOG(LogHaxeExtern, Error, TEXT("Corrupt reflection snapshot %s"), *inPath);
+    m_types.Reset();
+    m_exports.Reset();
+    return false;
+  }
+  return true;
+}
+
+void FHaxeSnapshotReplay::buildProperty(const TMap<FString, UObject *>& inObjects, UField *inOwner, const FHaxeSnapshotProperty& inProp) const {
+  UClass *propClass = FindObject<UClass>(nullptr, *inProp.propClass);
+  if (propClass == nullptr) {
+    UE_LOG(LogHaxeExtern, Fatal, TEXT("Unknown property class %s in the snapshot"), *inProp.propClass);
+  }
+  UProperty *prop = FHaxeReflectionBuilder::addProperty(inOwner, propClass, inProp.name, inProp.flags);
+  prop->ArrayDim = inProp.arrayDim;
+  if (!inProp.isPublic) {
+    prop->ClearFlags(RF_Public);
+  }
+  if (!inProp.isNativeBool) {
+    CastChecked<UBoolProperty>(prop)->SetBoolSize(sizeof(uint8), false, 1);
+  }
+  // the inner properties are added first, so an enum property doesn't get a default underlying property
+  for (auto& inner : inProp.inner) {
+    buildProperty(inObjects, prop, inner);
+  }
+  if (!inProp.type.IsEmpty()) {
+    FHaxeReflectionBuilder::setPropertyType(prop, findObject(inObjects, inProp.type));
+  }
+  setMetaData(prop, inProp.metaKeys, inProp.metaValues);
+}
+
+bool FHaxeSnapshotReplay::build(TMap<FString, UObject *>& outObjects) const {
+  // the types that already exist (e.g. the ones compiled into this program) are used as they are
+  TBitArray<> created(false, m_types.Num());
+  for (int32 i = 0; i < m_types.Num(); i++) {
+    const auto& type = m_types[i];
+    FString path = type.getPath();
+    UObject *existing = FindObject<UObject>(nullptr, *path);
+    if (existing != nullptr) {
+      outObjects.Add(path, existing);
+      continue;
+    }
+
+    UPackage *package = nullptr;
+    UObject *outer = outObjects.FindRef(type.outer);
+    if (outer == nullptr) {
+      package = FindObject<UPackage>(nullptr, *type.outer);
+      if (package == nullptr) {
+        package = FHaxeReflectionBuilder::createPackage(type.outer);
+      }
+      outer = package;
+    }
+
+    UObject *obj = nullptr;
+    switch (type.kind) {
+    case EHaxeSnapshotKind::Class:
+      obj = FHaxeReflectionBuilder::createClass(package, type.name, nullptr, type.flags);
+      break;
+    case EHaxeSnapshotKind::Struct:
+      obj = FHaxeReflectionBuilder::createStruct(package, type.name, nullptr, type.flags);
+      break;
+    case EHaxeSnapshotKind::Enum: {
+      TArray<TPair<FName, int64>> entries;
+      for (int32 e = 0; e < type.enumNames.Num(); e++) {
+        entries.Emplace(FName(*type.enumNames[e]), type.enumValues[e]);
+      }
+      obj = FHaxeReflectionBuilder::createEnum(package, type.name, entries, (UEnum::ECppForm) type.cppForm, type.cppType);
+      break;
+    }
+    case EHaxeSnapshotKind::Delegate: {
+      FString name = type.name;
+      name.RemoveFromEnd(TEXT("__DelegateSignature"));
+      UFunction *func = FHaxeReflectionBuilder::createDelegate(outer, name, (type.flags & FUNC_MulticastDelegate) != 0);
+      func->FunctionFlags = (EFunctionFlags) type.flags;
+      obj = func;
+      break;
+    }
+    case EHaxeSnapshotKind::Function: {
+      UFunction *func = FHaxeReflectionBuilder::createFunction(CastChecked<UClass>(outer), type.name, type.flags);
+      func->FunctionFlags = (EFunctionFlags) type.flags;
+      obj = func;
+      break;
+    }
+    }
+    if (obj == nullptr) {
+      UE_LOG(LogHaxeExtern, Error, TEXT("Cannot create %s from the snapshot"), *path);
+      return false;
+    }
+    outObjects.Add(path, obj);
+    created[i] = true;
+  }
+
+  TSet<UStruct *> createdStructs;
+  for (int32 i = 0; i < m_types.Num(); i++) {
+    if (!created[i]) {
+      continue;
+    }
+    const auto& type = m_types[i];
+    UObject *obj = outObjects[type.getPath()];
+    if (UClass *cls = Cast<UClass>(obj)) {
+      if (!type.super.IsEmpty()) {
+        UClass *super = CastChecked<UClass>(findObject(outObjects, type.super));
+        cls->SetSuperStruct(super);
+        cls->ClassWithin = super->ClassWithin;
+        cls->ClassConfigName = super->ClassConfigName;
+      }
+      for (auto& iface : type.interfaces) {
+        FHaxeReflectionBuilder::addInterface(cls, CastChecked<UClass>(findObject(outObjects, iface)));
+      }
+    } else if (UScriptStruct *ustruct = Cast<UScriptStruct>(obj)) {
+      if (!type.super.IsEmpty()) {
+        ustruct->SetSuperStruct(CastChecked<UScriptStruct>(findObject(outObjects, type.super)));
+      }
+    }
+
+    if (UStruct *ustruct = Cast<UStruct>(obj)) {
+      for (auto& prop : type.props) {
+        buildProperty(outObjects, ustruct, prop);
+      }
+      if (type.kind == EHaxeSnapshotKind::Class) {
+        relinkChildren(ustruct, type.children);
+      }
+      createdStructs.Add(ustruct);
+    }
+    setMetaData(CastChecked<UField>(obj), type.metaKeys, type.metaValues);
+  }
+
+  // super structs must be linked before the structs that extend them
+  TSet<UStruct *> finished;
+  for (UStruct *ustruct : createdStructs) {
+    finishWithSupers(ustruct, createdStructs, finished);
+  }
+  return true;
+}
+
+int32 FHaxeSnapshotReplay::run(const FString& inPath) {
+  FHaxeSnapshotReplay snapshot;
+  double start = FPlatformTime::Seconds();
+  if (!snapshot.load(inPath)) {
+    return 1;
+  }
+  TMap<FString, UObject *> objects;
+  if (!snapshot.build(objects)) {
+    return 1;
+  }
+  UE_LOG(LogHaxeExtern, Display, TEXT("Replay: loaded %d types from %s in %.3fms"), snapshot.m_types.Num(), *inPath, (FPlatformTime::Seconds() - start) * 1000.0);
+
+  FString outDir = FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_OUTPUT_DIR"));
+  auto& plugin = FModuleManager::LoadModuleChecked<IHaxeExternGenerator>(TEXT("UnrealHxGenerator"));
+  start = FPlatformTime::Seconds();
+  plugin.Initialize(outDir, outDir, outDir, outDir);
+  const FString *module = nullptr;
+  for (auto& exp : snapshot.m_exports) {
+    if (module == nullptr || *module != exp.module) {
+      plugin.ShouldExportClassesForModule(exp.module, EBuildModuleType::EngineRuntime, outDir);
+      module = &exp.module;
+    }
+    plugin.ExportClass(CastChecked<UClass>(findObject(objects, exp.classPath)), exp.header, FString(), true);
+  }
+  plugin.FinishExport();
+  UE_LOG(LogHaxeExtern, Display, TEXT("Replay: generated %d classes in %.3fms"), snapshot.m_exports.Num(), (FPlatformTime::Seconds() - start) * 1000.0);
+  return 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <CoreUObject.h>
+#include "HaxeReflectionSnapshot.h"
+
+/**
+ * Loads a reflection snapshot saved by the plugin (see `FHaxeReflectionSnapshot`), recreates its types and
+ * drives the plugin with them exactly like UHT would (`Initialize`, `ExportClass` and `FinishExport`)
+ **/
+class FHaxeSnapshotReplay {
+private:
+  TArray<FHaxeSnapshotType> m_types;
+  TArray<FHaxeSnapshotExport> m_exports;
+
+  bool load(const FString& inPath);
+
+  /**
+   * Creates the objects of every type that doesn't exist yet, and returns the object for each path
+   **/
+  bool build(TMap<FString, UObject *>& outObjects) const;
+
+  void buildProperty(const TMap<FString, UObject *>& inObjects, UField *inOwner, const FHaxeSnapshotProperty& inProp) const;
+
+public:
+  /**
+   * Replays the snapshot at `inPath`. The output goes to `EXTERN_OUTPUT_DIR`, like in a UHT run.
+   * Returns the process exit code.
+   *
+   * The plugin can only run once per process, as its type information is never cleared
+   **/
+  static int32 run(const FString& inPath);
+};
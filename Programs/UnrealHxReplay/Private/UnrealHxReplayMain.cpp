@@ -0,0 +1,26 @@
+#include "RequiredProgramMainCPPInclude.h"
+#include "HaxeSnapshotReplay.h"
+#include "Misc/Parse.h"
+
+IMPLEMENT_APPLICATION(UnrealHxReplay, "UnrealHxReplay");
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV() {
+  GEngineLoop.PreInit(ArgC, ArgV);
+  // e.g. `UnrealHxReplay -snapshot=/tmp/Game.uhxsnap -out=/path/to/Plugins/UnrealHx`
+  FString snapshot;
+  FString outDir;
+  int32 ret = 1;
+  if (!FParse::Value(FCommandLine::Get(), TEXT("snapshot="), snapshot)) {
+    UE_LOG(LogHaxeExtern, Error, TEXT("Usage: UnrealHxReplay -snapshot=<path> [-out=<EXTERN_OUTPUT_DIR>]"));
+  } else {
+    if (FParse::Value(FCommandLine::Get(), TEXT("out="), outDir)) {
+      FPlatformMisc::SetEnvironmentVar(TEXT("EXTERN_OUTPUT_DIR"), *outDir);
+    }
+    ret = FHaxeSnapshotReplay::run(snapshot);
+  }
+
+  FEngineLoop::AppPreExit();
+  FModuleManager::Get().UnloadModulesAtShutdown();
+  FEngineLoop::AppExit();
+  return ret;
+}
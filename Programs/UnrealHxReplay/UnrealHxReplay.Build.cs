@@ -0,0 +1,18 @@
+using UnrealBuildTool;
+
+public class UnrealHxReplay : ModuleRules {
+  public UnrealHxReplay(ReadOnlyTargetRules target) : base(target) {
+    PublicIncludePaths.Add("Runtime/Launch/Public");
+    PrivateIncludePaths.Add("Runtime/Launch/Private");
+    PrivateDependencyModuleNames.AddRange(
+      new string[]
+      {
+        "Core",
+        "CoreUObject",
+        "Projects",
+        "UnrealHxGenerator",
+        "UnrealHxGeneratorDev",
+      }
+    );
+  }
+}
@@ -0,0 +1,157 @@
+#include "HaxeBundler.h"
+#include "HAL/FileManager.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+
+static const TCHAR *ExtraSuffix = TEXT("_Extra.hx");
+// the bundles of a module are named `<Module>Types_<Letter>` or `<Module>Types_<Number>`
+static const TCHAR *BundleInfix = TEXT("Types_");
+
+void FHaxeBundler::init(const FString& inOutPath) {
+  FString mode = FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_BUNDLE"));
+  m_mode = EHaxeBundleMode::None;
+  if (mode.IsEmpty()) {
+    return;
+  }
+  if (mode == TEXT("letter")) {
+    m_mode = EHaxeBundleMode::Letter;
+  } else if (mode.StartsWith(TEXT("size:"))) {
+    m_budget = FCString::Atoi64(*mode.RightChop(5)) * 1024;
+    if (m_budget <= 0) {
+      UE_LOG(LogHaxeExtern, Fatal, TEXT("Invalid EXTERN_BUNDLE size: %s"), *mode);
+    }
+    m_mode = EHaxeBundleMode::Size;
+  } else {
+    UE_LOG(LogHaxeExtern, Fatal, TEXT("Invalid EXTERN_BUNDLE mode: %s (expected 'letter' or 'size:<kilobytes>')"), *mode);
+  }
+
+  findExtraTypes(inOutPath);
+  FString extraPaths = FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_EXTRA_PATHS"));
+  TArray<FString> roots;
+  extraPaths.ParseIntoArray(roots, TEXT(";"), true);
+  for (auto& root : roots) {
+    findExtraTypes(root);
+  }
+}
+
+void FHaxeBundler::findExtraTypes(const FString& inRoot) {
+  FString root = FPaths::ConvertRelativePathToFull(inRoot);
+  if (!root.EndsWith(TEXT("/"))) {
+    root += TEXT("/");
+  }
+  TArray<FString> files;
+  IFileManager::Get().FindFilesRecursive(files, *root, TEXT("*_Extra.hx"), true, false);
+  for (auto& file : files) {
+    FString path = FPaths::ConvertRelativePathToFull(file);
+    if (!path.StartsWith(root)) {
+      continue;
+    }
+    // e.g. unreal/AActor_Extra.hx -> unreal.AActor
+    FString typePath = path.Mid(root.Len(), path.Len() - root.Len() - FCString::Strlen(ExtraSuffix));
+    m_extraTypes.Add(typePath.Replace(TEXT("/"), TEXT(".")));
+  }
+}
+
+int64 FHaxeBundler::estimateSize(const FHaxeTypeEntry& inEntry) {
+  // roughly what the generator outputs for a type and for each of its fields
+  static const int64 TypeSize = 512;
+  static const int64 FieldSize = 192;
+  static const int64 EnumEntrySize = 48;
+
+  int64 numFields = 0;
+  switch (inEntry.kind) {
+  case ETypeKind::KUEnum:
+    return TypeSize + inEntry.uenum->uenum->NumEnums() * EnumEntrySize;
+  case ETypeKind::KUStruct:
+    for (TFieldIterator<UField> it(inEntry.ustruct->ustruct, EFieldIteratorFlags::ExcludeSuper); it; ++it) {
+      numFields++;
+    }
+    break;
+  case ETypeKind::KUDelegate:
+    for (TFieldIterator<UProperty> it(inEntry.udelegate->delegateSignature); it; ++it) {
+      numFields++;
+    }
+    break;
+  default:
+    for (TFieldIterator<UField> it(inEntry.cls->uclass, EFieldIteratorFlags::ExcludeSuper); it; ++it) {
+      numFields++;
+    }
+    break;
+  }
+  return TypeSize + numFields * FieldSize;
+}
+
+bool FHaxeBundler::isBundle(const FString& inHaxeModule, const FString& inModule) {
+  int32 prefixLen = inModule.Len() + FCString::Strlen(BundleInfix);
+  if (inHaxeModule.Len() <= prefixLen || !inHaxeModule.StartsWith(inModule, ESearchCase::CaseSensitive) ||
+      FCString::Strncmp(*inHaxeModule + inModule.Len(), BundleInfix, FCString::Strlen(BundleInfix)) != 0) {
+    return false;
+  }
+  FString suffix = inHaxeModule.RightChop(prefixLen);
+  if (suffix.Len() == 1 && (FChar::IsUpper(suffix[0]) || suffix[0] == TCHAR('_'))) {
+    return true;
+  }
+  for (TCHAR chr : suffix) {
+    if (!FChar::IsDigit(chr)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FHaxeBundler::assign(FHaxeTypes& inTypes, TArray<int32>& outBundled) const {
+  if (m_mode == EHaxeBundleMode::None) {
+    return;
+  }
+
+  // group the types by Haxe package and UE module
+  TMap<FString, TArray<int32>> groups;
+  TMap<FString, FString> groupModules;
+  for (int32 id = 0; id < inTypes.getNumTypes(); id++) {
+    auto& entry = inTypes.getType(id);
+    const auto& hxType = entry.getHaxeType();
+    if (!entry.exported || hxType.haxeGenerated || !hxType.getHaxeModule().IsEmpty() || hxType.getPack().Num() == 0) {
+      continue;
+    }
+    if (!entry.shouldGenerate(true) || m_extraTypes.Contains(hxType.getTypePath())) {
+      continue;
+    }
+    FString module = FPackageName::GetShortName(entry.getPackage());
+    FString key = hxType.getPackageName() + TEXT("|") + module;
+    groups.FindOrAdd(key).Add(id);
+    groupModules.Add(key, module);
+  }
+
+  for (auto& group : groups) {
+    TArray<int32>& ids = group.Value;
+    const FString& module = groupModules[group.Key];
+    // sort by name so that the bundles don't depend on the order the types were found
+    ids.Sort([&inTypes](int32 a, int32 b) {
+      return inTypes.getType(a).getHaxeType().getName() < inTypes.getType(b).getHaxeType().getName();
+    });
+
+    int32 bundle = 0;
+    int64 bundleSize = 0;
+    for (int32 id : ids) {
+      const auto& hxType = inTypes.getType(id).getHaxeType();
+      FString haxeModule;
+      if (m_mode == EHaxeBundleMode::Letter) {
+        // skip the prefix (e.g. the `U` of `UObject`) so the types are spread over more bundles
+        const FString& name = hxType.uname;
+        TCHAR letter = name.Len() > 1 ? name[1] : name[0];
+        letter = FChar::IsAlpha(letter) ? FChar::ToUpper(letter) : TCHAR('_');
+        haxeModule = module + BundleInfix + FString::Chr(letter);
+      } else {
+        int64 size = estimateSize(inTypes.getType(id));
+        if (bundleSize > 0 && bundleSize + size > m_budget) {
+          bundle++;
+          bundleSize = 0;
+        }
+        bundleSize += size;
+        haxeModule = module + BundleInfix + FString::FromInt(bundle);
+      }
+      inTypes.setHaxeModule(id, haxeModule);
+      outBundled.Add(id);
+    }
+  }
+}
@@ -0,0 +1,172 @@
+#include "HaxeChangeList.h"
+#include "HaxeTypes.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+
+void FHaxeChangeList::begin(const FHaxeOutputManifest& inManifest) {
+  m_previousFiles.Reset();
+  m_previousTypes.Reset();
+  inManifest.getAllTypes(m_previousFiles);
+  for (auto& file : m_previousFiles) {
+    m_previousTypes.Append(file.Value);
+  }
+}
+
+static void writeSorted(TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>>& inWriter, const TCHAR *inName, const TSet<FString>& inValues) {
+  TArray<FString> values = inValues.Array();
+  values.Sort();
+  inWriter->WriteArrayStart(inName);
+  for (auto& value : values) {
+    inWriter->WriteValue(value);
+  }
+  inWriter->WriteArrayEnd();
+}
+
+static TSet<FString> readSet(const TSharedPtr<FJsonObject>& inObj, const TCHAR *inName) {
+  TSet<FString> ret;
+  const TArray<TSharedPtr<FJsonValue>> *values = nullptr;
+  if (inObj.IsValid() && inObj->TryGetArrayField(inName, values)) {
+    for (auto& value : *values) {
+      ret.Add(value->AsString());
+    }
+  }
+  return ret;
+}
+
+/**
+ * Merges the changes of a previous run (`inPrevious`) into the ones of this run, so that the result is what changed
+ * since before the previous run. e.g. a file that was added and then modified is still added, and a file that was
+ * added and then removed isn't listed at all
+ **/
+static void mergeChanges(const TSharedPtr<FJsonObject>& inPrevious, TSet<FString>& refAdded, TSet<FString>& refModified, TSet<FString>& refRemoved) {
+  for (auto& added : readSet(inPrevious, TEXT("added"))) {
+    refModified.Remove(added);
+    if (refRemoved.Remove(added) == 0) {
+      refAdded.Add(added);
+    }
+  }
+  for (auto& modified : readSet(inPrevious, TEXT("modified"))) {
+    if (!refRemoved.Contains(modified)) {
+      refAdded.Remove(modified);
+      refModified.Add(modified);
+    }
+  }
+  for (auto& removed : readSet(inPrevious, TEXT("removed"))) {
+    if (refAdded.Remove(removed) > 0 || refModified.Contains(removed)) {
+      refModified.Add(removed);
+    } else {
+      refRemoved.Add(removed);
+    }
+  }
+}
+
+bool FHaxeChangeList::save(const FString& inPath, const FHaxeOutputManifest& inManifest) const {
+  TMap<FString, TArray<FString>> currentFiles;
+  inManifest.getAllTypes(currentFiles);
+  TSet<FString> currentTypes;
+  for (auto& file : currentFiles) {
+    currentTypes.Append(file.Value);
+  }
+
+  TSet<FString> addedTypes, modifiedTypes, removedTypes;
+  auto addWritten = [&](const FString& inFile) {
+    auto types = currentFiles.Find(inFile);
+    if (types == nullptr) {
+      return;
+    }
+    for (auto& type : *types) {
+      if (m_previousTypes.Contains(type)) {
+        modifiedTypes.Add(type);
+      } else {
+        addedTypes.Add(type);
+      }
+    }
+  };
+  // the types that a file declared before it was rewritten (or removed) may not exist anymore
+  auto removeStale = [&](const FString& inFile) {
+    auto types = m_previousFiles.Find(inFile);
+    if (types == nullptr) {
+      return;
+    }
+    for (auto& type : *types) {
+      if (!currentTypes.Contains(type)) {
+        removedTypes.Add(type);
+      }
+    }
+  };
+  for (auto& file : m_added) {
+    addWritten(file);
+  }
+  for (auto& file : m_modified) {
+    addWritten(file);
+    removeStale(file);
+  }
+  for (auto& file : m_removed) {
+    removeStale(file);
+  }
+
+  auto toFullPaths = [](const TSet<FString>& inFiles) {
+    TSet<FString> ret;
+    for (auto& file : inFiles) {
+      // the manifest has standard filenames, which may be relative to the base dir
+      ret.Add(FPaths::ConvertRelativePathToFull(file));
+    }
+    return ret;
+  };
+  TSet<FString> addedFiles = toFullPaths(m_added);
+  TSet<FString> modifiedFiles = toFullPaths(m_modified);
+  TSet<FString> removedFiles = toFullPaths(m_removed);
+
+  // the file is only replaced once a consumer deleted it, so the changes of the runs it missed are kept
+  int32 runs = 1;
+  FString previous;
+  if (FFileHelper::LoadFileToString(previous, *inPath)) {
+    TSharedPtr<FJsonObject> prevObj;
+    auto reader = TJsonReaderFactory<TCHAR>::Create(previous);
+    if (FJsonSerializer::Deserialize(reader, prevObj) && prevObj.IsValid()) {
+      const TSharedPtr<FJsonObject> *prevFiles = nullptr;
+      const TSharedPtr<FJsonObject> *prevTypes = nullptr;
+      if (prevObj->TryGetObjectField(TEXT("files"), prevFiles)) {
+        mergeChanges(*prevFiles, addedFiles, modifiedFiles, removedFiles);
+      }
+      if (prevObj->TryGetObjectField(TEXT("types"), prevTypes)) {
+        mergeChanges(*prevTypes, addedTypes, modifiedTypes, removedTypes);
+      }
+      int32 prevRuns = 0;
+      if (prevObj->TryGetNumberField(TEXT("runs"), prevRuns)) {
+        runs += prevRuns;
+      }
+    } else {
+      UE_LOG(LogHaxeExtern, Warning, TEXT("Cannot parse the change list at path %s. Its changes will be lost"), *inPath);
+    }
+  }
+
+  FString json;
+  {
+    auto writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&json);
+    writer->WriteObjectStart();
+    writer->WriteValue(TEXT("runs"), runs);
+    writer->WriteObjectStart(TEXT("files"));
+    writeSorted(writer, TEXT("added"), addedFiles);
+    writeSorted(writer, TEXT("modified"), modifiedFiles);
+    writeSorted(writer, TEXT("removed"), removedFiles);
+    writer->WriteObjectEnd();
+    writer->WriteObjectStart(TEXT("types"));
+    writeSorted(writer, TEXT("added"), addedTypes);
+    writeSorted(writer, TEXT("modified"), modifiedTypes);
+    writeSorted(writer, TEXT("removed"), removedTypes);
+    writer->WriteObjectEnd();
+    writer->WriteObjectEnd();
+    writer->Close();
+  }
+  if (!FFileHelper::SaveStringToFile(json, *inPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM)) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Cannot write change list at path %s"), *inPath);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,103 @@
+#include "HaxeDependencyGraph.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+
+static const TCHAR *getKindName(ETypeKind inKind) {
+  switch (inKind) {
+  case ETypeKind::KUStruct:
+    return TEXT("struct");
+  case ETypeKind::KUEnum:
+    return TEXT("enum");
+  case ETypeKind::KUDelegate:
+    return TEXT("delegate");
+  case ETypeKind::KUInterface:
+    return TEXT("interface");
+  default:
+    return TEXT("class");
+  }
+}
+
+void FHaxeDependencyGraph::build(FHaxeTypes& inTypes) {
+  m_dependencies.Reset();
+  m_dependents.Reset();
+  m_dependencies.SetNum(inTypes.getNumTypes());
+  m_dependents.SetNum(inTypes.getNumTypes());
+  TArray<int32> ids;
+  for (int32 id = 0; id < inTypes.getNumTypes(); id++) {
+    const auto& entry = inTypes.getType(id);
+    if (!entry.exported) {
+      continue;
+    }
+    ids.Reset();
+    inTypes.getDependencies(entry, ids);
+    for (int32 dep : ids) {
+      if (dep != id && inTypes.getType(dep).exported) {
+        m_dependencies[id].AddUnique(dep);
+      }
+    }
+    for (int32 dep : m_dependencies[id]) {
+      m_dependents[dep].Add(id);
+    }
+  }
+}
+
+bool FHaxeDependencyGraph::save(const FHaxeTypes& inTypes, const FString& inPath) const {
+  // sort everything by name, so the same types always result in the same file
+  auto getName = [&inTypes](int32 inId) {
+    return inTypes.getType(inId).getHaxeType().toString();
+  };
+  auto writeNames = [&](TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>>& inWriter, const TCHAR *inField, const TArray<int32>& inIds) {
+    TArray<FString> names;
+    names.Reserve(inIds.Num());
+    for (int32 id : inIds) {
+      names.Add(getName(id));
+    }
+    names.Sort();
+    inWriter->WriteArrayStart(inField);
+    for (auto& name : names) {
+      inWriter->WriteValue(name);
+    }
+    inWriter->WriteArrayEnd();
+  };
+
+  TArray<TPair<FString, int32>> types;
+  for (int32 id = 0; id < inTypes.getNumTypes(); id++) {
+    if (inTypes.getType(id).exported) {
+      types.Emplace(getName(id), id);
+    }
+  }
+  types.Sort([](const TPair<FString, int32>& a, const TPair<FString, int32>& b) {
+    return a.Key < b.Key;
+  });
+
+  FString json;
+  {
+    auto writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&json);
+    writer->WriteObjectStart();
+    writer->WriteObjectStart(TEXT("types"));
+    for (auto& type : types) {
+      int32 id = type.Value;
+      const auto& entry = inTypes.getType(id);
+      writer->WriteObjectStart(type.Key);
+      writer->WriteValue(TEXT("kind"), FString(getKindName(entry.kind)));
+      writer->WriteValue(TEXT("module"), entry.getHaxeType().module);
+      writeNames(writer, TEXT("dependencies"), m_dependencies[id]);
+      writeNames(writer, TEXT("dependents"), m_dependents[id]);
+      writer->WriteObjectEnd();
+    }
+    writer->WriteObjectEnd();
+    writer->WriteObjectEnd();
+    writer->Close();
+  }
+  // the incremental build looks at its modification time, so it's only written when it changes
+  FString previous;
+  if (FFileHelper::LoadFileToString(previous, *inPath) && previous.Equals(json, ESearchCase::CaseSensitive)) {
+    return true;
+  }
+  if (!FFileHelper::SaveStringToFile(json, *inPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM)) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Cannot write dependency graph at path %s"), *inPath);
+    return false;
+  }
+  return true;
+}
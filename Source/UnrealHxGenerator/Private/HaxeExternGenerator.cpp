@@ -2,7 +2,22 @@
 #include <Features/IModularFeatures.h>
 #include "HaxeGenerator.h"
 #include "Misc/Paths.h"
+#include "Misc/PackageName.h"
+#include "Misc/FileHelper.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTLS.h"
+#include "UObject/UObjectHash.h"
 #include "HaxeTypes.h"
+#include "HaxeOutputManifest.h"
+#include "HaxeGenerationCache.h"
+#include "HaxeFileSink.h"
+#include "HaxeGeneratorStats.h"
+#include "HaxeWriteQueue.h"
+#include "HaxeBundler.h"
+#include "HaxeTypeDatabase.h"
+#include "HaxeReflectionSnapshot.h"
+#include "HaxeChangeList.h"
+#include "HaxeDependencyGraph.h"
 
 DEFINE_LOG_CATEGORY(LogHaxeExtern);
 
@@ -26,47 +41,60 @@ static const FString prelude2 =
 
 static const FString preludeComment = FString(TEXT("/**\n")) + prelude + prelude2 + FString(TEXT("**/\n"));
 
-static TSet<FString> getReadOnlyStructNames() {
-  // CppStuctOps doesn't work inside the header parser
-  // so we need to manually add non-copy fields here
-  TSet<FString> ret;
-  ret.Add(TEXT("SkeletalMeshComponentEndPhysicsTickFunction"));
-  ret.Add(TEXT("SkeletalMeshComponentClothTickFunction"));
-  ret.Add(TEXT("StaticMeshComponentLODInfo"));
-  ret.Add(TEXT("KeyHandleMap"));
-  ret.Add(TEXT("RichCurveKey"));
-  ret.Add(TEXT("PointerToUberGraphFrame"));
-  ret.Add(TEXT("TickFunction"));
-  ret.Add(TEXT("ActorTickFunction"));
-  ret.Add(TEXT("ActorComponentTickFunction"));
-  ret.Add(TEXT("PrimitiveComponentPostPhysicsTickFunction"));
-  ret.Add(TEXT("StartPhysicsTickFunction"));
-  ret.Add(TEXT("EndPhysicsTickFunction"));
-  ret.Add(TEXT("StartAsyncSimulationFunction"));
-  ret.Add(TEXT("LevelCollection"));
-  ret.Add(TEXT("CharacterMovementComponentPostPhysicsTickFunction"));
-  ret.Add(TEXT("BodyInstance"));
-  ret.Add(TEXT("StartPhysics2DTickFunction"));
-  ret.Add(TEXT("EndPhysics2DTickFunction"));
-  ret.Add(TEXT("TestTickFunction"));
-  ret.Add(TEXT("CachedMovieSceneEvaluationTemplate"));
-  ret.Add(TEXT("MovieSceneEvaluationTrack"));
-  return ret;
-}
+// how many of the types that took the longest to generate are listed in the stats
+static const int32 SlowestTypesInStats = 50;
 
-static bool structHasCopy(UScriptStruct *inStruct) {
-  static TSet<FString> structNames = getReadOnlyStructNames();
-  return !structNames.Contains(inStruct->GetName());
-}
+// how many files can wait to be written before the generator waits for the I/O workers
+static const int32 WriteQueueCapacity = 256;
+static const int32 WriteQueueWorkers = 4;
 
 class FHaxeExternGenerator : public IHaxeExternGenerator {
 protected:
+  struct FPartialFile {
+    FString module;
+    FString contents;
+  };
+
+  // the time a write queue worker spent on a file
+  struct FWriteTime {
+    FString file;
+    double start;
+    double end;
+    uint32 threadId;
+  };
+
   FString m_pluginPath;
   FString m_outPath;
   FHaxeTypes m_types;
-  TMap<FString, FString> m_partialFiles;
+  TMap<FString, FPartialFile> m_partialFiles;
+  FHaxeOutputManifest m_manifest;
+  FHaxeChangeList m_changes;
+  // the Haxe types saved to each file in this run
+  TMap<FString, TArray<FString>> m_fileTypes;
+  // the files that were queued to be written in this run
+  TSet<FString> m_queuedFiles;
+  FHaxeGenerationCache m_cache;
+  FHaxeTypeStringCache m_typeStrings;
+  FHaxeGeneratorPool m_generators;
+  FHaxeGeneratorStats m_stats;
+  FHaxeBundler m_bundler;
+  // where the reflection snapshot is saved, if one was asked for (`EXTERN_SNAPSHOT`)
+  FString m_snapshotPath;
+  FHaxeReflectionSnapshot m_snapshot;
+  // the output directory of each Haxe package that is known to exist
+  TMap<const FHaxePackage *, FString> m_outDirs;
+  // protects the manifest, the file stats and the write times, which are updated by the write queue workers
+  FCriticalSection m_outputLock;
+  TArray<FWriteTime> m_writeTimes;
+  FHaxeWriteQueue m_writeQueue;
   static FString currentModule;
 public:
+  FHaxeExternGenerator() :
+    m_generators(m_types, &m_typeStrings),
+    m_writeQueue([this](FHaxeWriteJob& inJob, FString& outError) { return this->writeFile(inJob, outError); },
+        useParallelGeneration() ? WriteQueueWorkers : 0, WriteQueueCapacity)
+  {
+  }
 
   virtual void StartupModule() override {
     IModularFeatures::Get().RegisterModularFeature(TEXT("ScriptGenerator"), this);
@@ -96,6 +124,7 @@ public:
 
   /** Initializes this plugin with build information */
   virtual void Initialize(const FString& RootLocalPath, const FString& RootBuildPath, const FString& OutputDirectory, const FString& IncludeBase) override {
+    m_stats.start(!FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_TRACE")).IsEmpty());
     FString pluginPath = FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_OUTPUT_DIR"));
     LOG("Output dir: %s", *pluginPath);
     if (pluginPath.IsEmpty()) {
@@ -111,184 +140,728 @@ public:
     } else {
       m_outPath = externOutPath;
     }
-    this->m_types = FHaxeTypes(m_outPath);
+    this->m_types.setOutPath(m_outPath);
+    FString configPath = FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_GENERATOR_CONFIG"));
+    if (configPath.IsEmpty()) {
+      configPath = m_pluginPath / TEXT("UnrealHxGenerator.ini");
+    }
+    FHaxeGeneratorConfig::get().load(configPath);
+    m_manifest.load(m_pluginPath / TEXT("UnrealHxGenerator.manifest"), m_outPath);
+    m_bundler.init(m_outPath);
+    m_snapshotPath = FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_SNAPSHOT"));
+    if (useGenerationCache()) {
+      // engine and game code runs generate different sets of types, so each gets its own cache
+      FString cacheConfig = m_outPath + TEXT("|") +
+        FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_MODULES")) + TEXT("|") +
+        FPlatformMisc::GetEnvironmentVariable(TEXT("UNREAL_EXTERN_MODULES")) + TEXT("|") +
+        FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_BUNDLE"));
+      FString configContents;
+      if (!FHaxeGeneratorConfig::get().getPath().IsEmpty()) {
+        // the filters change what is generated, so a different config gets a different cache
+        FFileHelper::LoadFileToString(configContents, *FHaxeGeneratorConfig::get().getPath());
+        cacheConfig += TEXT("|") + configContents;
+      }
+      m_cache.load(m_pluginPath / FString::Printf(TEXT("UnrealHxGenerator-%08x.cache"), FCrc::StrCrc32(*cacheConfig)));
+    }
   }
 
   /** Exports a single class. May be called multiple times for the same class (as UHT processes the entire hierarchy inside modules. */
   virtual void ExportClass(class UClass* Class, const FString& SourceHeaderFilename, const FString& GeneratedHeaderFilename, bool bHasChanged) override {
-    FString comment = Class->GetMetaData(TEXT("ToolTip"));
+    double start = FPlatformTime::Seconds();
     m_types.touchClass(Class, SourceHeaderFilename, currentModule);
+    if (!m_snapshotPath.IsEmpty()) {
+      m_snapshot.record(Class, SourceHeaderFilename, currentModule);
+    }
+    // the name is only needed by the trace, and getting it allocates
+    m_stats.addPhase(TEXT("touch"), start, FPlatformTime::Seconds(), 1, m_stats.isTracing() ? Class->GetName() : FString());
   }
 
-  void saveFile(const FString& file, FString& contents, bool append) {
-    FString lastContents;
+  /**
+   * Queues a file to be written, or appends to a file that is written once every type was saved.
+   * Returns false if the file was already queued
+   **/
+  bool saveFile(const FString& file, const FString& module, FString header, FString contents, bool append) {
     if (append) {
-      FString &refContents = m_partialFiles.FindOrAdd(file);
+      FPartialFile &refPartial = m_partialFiles.FindOrAdd(file);
+      refPartial.module = module;
+      FString &refContents = refPartial.contents;
       if (!refContents.IsEmpty()) {
         refContents += TEXT("\n\n");
       }
+      refContents += header;
       refContents += contents;
-    } else if (!FFileHelper::LoadFileToString(lastContents, *file, FFileHelper::EHashOptions::None) || lastContents != contents) {
-      if (!FFileHelper::SaveStringToFile(contents, *file, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM)) {
-        UE_LOG(LogHaxeExtern, Fatal, TEXT("Cannot write file at path %s"), *file);
-      }
-    } else {
-      LOG("File %s is up-to-date", *file);
+      return true;
+    }
+
+    // two jobs for the same file would race on the same temporary file, and the last one to be published would win
+    bool alreadyQueued = false;
+    m_queuedFiles.Add(file, &alreadyQueued);
+    if (alreadyQueued) {
+      UE_LOG(LogHaxeExtern, Warning, TEXT("File %s was already generated by another type. Ignoring the new contents"), *file);
+      return false;
     }
+
+    FHaxeWriteJob job;
+    job.file = file;
+    job.module = module;
+    job.header = MoveTemp(header);
+    job.contents = MoveTemp(contents);
+    m_writeQueue.enqueue(MoveTemp(job));
+    return true;
   }
 
-  void saveFile(const FHaxeTypeRef& inHaxeType, FString& contents, TSet<FString>& refTouched, TSet<FString>& refAppend) {
-    auto& fileMan = IFileManager::Get();
-    auto outPath = this->m_outPath / FString::Join(inHaxeType.pack, TEXT("/"));
-    if (!fileMan.DirectoryExists(*outPath)) {
-      fileMan.MakeDirectory(*outPath, true);
+  /**
+   * Writes a file if it changed since the last run, and keeps how long it took. Called by the write queue workers
+   **/
+  bool writeFile(FHaxeWriteJob& inJob, FString& outError) {
+    FWriteTime time;
+    time.start = FPlatformTime::Seconds();
+    bool ret = updateFile(inJob, outError);
+    time.end = FPlatformTime::Seconds();
+    time.threadId = FPlatformTLS::GetCurrentThreadId();
+    if (m_stats.isTracing()) {
+      time.file = inJob.file;
+    }
+    FScopeLock lock(&m_outputLock);
+    m_writeTimes.Add(MoveTemp(time));
+    return ret;
+  }
+
+  bool updateFile(FHaxeWriteJob& inJob, FString& outError) {
+    // we compare the hash of the new contents with the hash we've written last time, instead of reading the file back.
+    // Most files are up-to-date, so we only hash them first and only convert them again if they need to be written
+    FHaxeFileSink hasher;
+    hasher.write(inJob.header).write(inJob.contents);
+    auto hash = hasher.finishHash();
+    bool upToDate;
+    {
+      FScopeLock lock(&m_outputLock);
+      upToDate = m_manifest.isUpToDate(inJob.file, hash);
+    }
+    // the manifest can't know if the file was deleted since it was written (e.g. by hand or by `git clean`)
+    bool existed = IFileManager::Get().FileExists(*inJob.file);
+    if (upToDate && existed) {
+      LOG("File %s is up-to-date", *inJob.file);
+      FScopeLock lock(&m_outputLock);
+      m_stats.addFile(inJob.module, hasher.getSize(), false);
+      return true;
+    }
+    FHaxeFileSink sink;
+    if (!sink.open(inJob.file)) {
+      outError = FString::Printf(TEXT("Cannot write file at path %s"), *inJob.file);
+      return false;
+    }
+    sink.write(inJob.header).write(inJob.contents);
+    if (!sink.commit()) {
+      outError = FString::Printf(TEXT("Cannot write file at path %s"), *inJob.file);
+      return false;
+    }
+
+    FScopeLock lock(&m_outputLock);
+    m_manifest.update(inJob.file, hash);
+    m_changes.addFile(inJob.file, existed);
+    m_stats.addFile(inJob.module, hasher.getSize(), true);
+    return true;
+  }
+
+  void saveFile(const FHaxeTypeRef& inHaxeType, FString contents, TSet<FString>& refTouched, TSet<FString>& refAppend) {
+    FString *found = m_outDirs.Find(inHaxeType.getPackage());
+    if (found == nullptr) {
+      auto& fileMan = IFileManager::Get();
+      FString dir = this->m_outPath / inHaxeType.getPackagePath();
+      if (!fileMan.DirectoryExists(*dir)) {
+        fileMan.MakeDirectory(*dir, true);
+      }
+      found = &m_outDirs.Add(inHaxeType.getPackage(), dir);
     }
+    const FString& outPath = *found;
 
     FString file;
-    if (inHaxeType.haxeModule.IsEmpty()) {
-      file = outPath / inHaxeType.name + TEXT(".hx");
+    if (inHaxeType.getHaxeModule().IsEmpty()) {
+      file = outPath / inHaxeType.getName() + TEXT(".hx");
     } else {
-      file = outPath / inHaxeType.haxeModule + TEXT(".hx");
+      file = outPath / inHaxeType.getHaxeModule() + TEXT(".hx");
     }
     FPaths::MakeStandardFilename(file);
-    if (inHaxeType.pack.Num() > 0) {
+    FString header;
+    if (inHaxeType.getPack().Num() > 0) {
       if (!refTouched.Contains(file)) {
-        contents = preludeComment + FString(TEXT("package ")) + FString::Join(inHaxeType.pack, TEXT(".")) + TEXT(";\n\n") + contents;
+        header = preludeComment + FString(TEXT("package ")) + inHaxeType.getPackageName() + TEXT(";\n\n");
       }
     }
 
-    FString name = FString::Join(inHaxeType.pack, TEXT(".")) + TEXT(".") + inHaxeType.name;
+    if (saveFile(file, inHaxeType.module, MoveTemp(header), MoveTemp(contents), refAppend.Contains(inHaxeType.getTypePath()))) {
+      m_fileTypes.FindOrAdd(file).Add(inHaxeType.toString());
+      refTouched.Add(file);
+    }
+  }
 
-    saveFile(file, contents, refAppend.Contains(name));
-    refTouched.Add(file);
+  enum class EGenResult {
+    Skipped,
+    Generated,
+    Failed
+  };
+
+  struct FGenResult {
+    EGenResult state;
+    FString contents;
+    FString cacheKey;
+    FSHAHash fingerprint;
+    // only used for the stats
+    double start;
+    double end;
+    uint32 threadId;
+    bool cached;
+
+    FGenResult() : state(EGenResult::Skipped), start(0), end(0), threadId(0), cached(false)
+    {
+    }
+  };
+
+  /**
+   * The path of a file that describes the output of this run. It's put next to the output directory and named after
+   * it (e.g. `Haxe/Externs.typedb`), so that engine and game runs, which output to different directories, never
+   * overwrite each other's files
+   **/
+  FString getOutputSidePath(const TCHAR *inSuffix) const {
+    FString dir = m_outPath;
+    FPaths::NormalizeDirectoryName(dir);
+    return dir + inSuffix;
+  }
+
+  static bool useParallelGeneration() {
+    static bool singleThreaded = !FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_SINGLE_THREADED")).IsEmpty();
+    return !singleThreaded;
+  }
+
+  /**
+   * Only generate the types that can be reached from the classes of the `EXTERN_MODULES`, instead of
+   * every type of every module we generate. Only makes sense when compiling game code
+   **/
+  static bool useReachableOnly() {
+    static bool reachableOnly = !FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_REACHABLE_ONLY")).IsEmpty();
+    return reachableOnly && HaxeTypeHelpers::compilingGameCode();
+  }
+
+  /**
+   * Writes the binary type database at the end of the run. It resolves the type of every field again, so it's only
+   * built when a tool asks for it
+   **/
+  static bool useTypeDatabase() {
+    static bool typeDatabase = !FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_TYPE_DATABASE")).IsEmpty();
+    return typeDatabase;
+  }
+
+  static bool useGenerationCache() {
+    static bool noCache = !FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_NO_CACHE")).IsEmpty();
+    return !noCache;
+  }
+
+  /**
+   * Generates the Haxe code of a single type, or reuses the code generated on the last run if its fingerprint
+   * didn't change. Can be called from any thread
+   **/
+  template<typename T>
+  void generateType(const T *inType, bool (FHaxeGenerator::*inGenerate)(const T *), FGenResult& outResult) {
+    const FHaxeTypes& types = this->m_types;
+    const FHaxeGenerationCache& cache = this->m_cache;
+    outResult.start = FPlatformTime::Seconds();
+    outResult.threadId = FPlatformTLS::GetCurrentThreadId();
+    if (useGenerationCache()) {
+      outResult.cacheKey = FHaxeGenerationCache::getKey(inType);
+      outResult.fingerprint = cache.fingerprint(types, inType);
+      auto cached = cache.find(outResult.cacheKey, outResult.fingerprint);
+      if (cached != nullptr) {
+        outResult.state = cached->generated ? EGenResult::Generated : EGenResult::Failed;
+        outResult.contents = cached->contents;
+        outResult.cached = true;
+        outResult.end = FPlatformTime::Seconds();
+        return;
+      }
+    }
+
+    auto gen = m_generators.acquire();
+    if ((gen->*inGenerate)(inType)) {
+      outResult.state = EGenResult::Generated;
+      gen->copyTo(outResult.contents);
+    } else {
+      outResult.state = EGenResult::Failed;
+    }
+    m_generators.release(gen);
+    outResult.end = FPlatformTime::Seconds();
+  }
+
+  static const TCHAR *getKindName(ETypeKind inKind) {
+    switch (inKind) {
+    case ETypeKind::KUStruct:
+      return TEXT("struct");
+    case ETypeKind::KUEnum:
+      return TEXT("enum");
+    case ETypeKind::KUDelegate:
+      return TEXT("delegate");
+    default:
+      return TEXT("class");
+    }
   }
 
-  /** Called once all classes have been exported */
-  virtual void FinishExport() override {
-    for (FRawObjectIterator it(false); it; ++it) {
-      UObject* obj = (UObject*) it->Object;
-      if (obj->HasAnyFlags(RF_ClassDefaultObject)) {
+  /**
+   * Generates the Haxe code of either all delegates or all the other types in the type table, in parallel.
+   * `m_types` must not be modified while this runs. The results are indexed by type id
+   **/
+  TArray<FGenResult> generateTypes(bool inDelegates) {
+    FHaxeStatsScope scope(m_stats, inDelegates ? TEXT("generate delegates") : TEXT("generate types"));
+    TArray<FGenResult> ret;
+    ret.SetNum(m_types.getNumTypes());
+    ParallelFor(m_types.getNumTypes(), [&](int32 id) {
+      auto& entry = m_types.getType(id);
+      if (!entry.exported || (entry.kind == ETypeKind::KUDelegate) != inDelegates) {
+        return;
+      }
+      if (!entry.shouldGenerate(true)) {
+        return;
+      }
+      switch (entry.kind) {
+      case ETypeKind::KUStruct:
+        generateType(entry.ustruct, &FHaxeGenerator::generateStruct, ret[id]);
+        break;
+      case ETypeKind::KUEnum:
+        generateType(entry.uenum, &FHaxeGenerator::generateEnum, ret[id]);
+        break;
+      case ETypeKind::KUDelegate:
+        generateType(entry.udelegate, &FHaxeGenerator::generateDelegate, ret[id]);
+        break;
+      default:
+        generateType(entry.cls, &FHaxeGenerator::generateClass, ret[id]);
+        break;
+      }
+    }, !useParallelGeneration());
+
+    scope.count = 0;
+    for (int32 id = 0; id < ret.Num(); id++) {
+      auto& result = ret[id];
+      if (result.state != EGenResult::Skipped) {
+        auto& entry = m_types.getType(id);
+        m_stats.addType(getKindName(entry.kind), entry.getHaxeType().toString(), result.start, result.end, result.threadId, result.cached);
+        scope.count++;
+      }
+    }
+
+    if (useGenerationCache()) {
+      for (auto& result : ret) {
+        if (result.state != EGenResult::Skipped) {
+          FHaxeCachedType cached;
+          cached.fingerprint = result.fingerprint;
+          cached.generated = result.state == EGenResult::Generated;
+          cached.contents = result.contents;
+          m_cache.add(result.cacheKey, cached);
+        }
+      }
+    }
+    return ret;
+  }
+
+  /**
+   * Deletes the files inside the output directory that were generated by a previous run, but not by this one.
+   * The manifest knows which files we wrote; only if it's missing (or corrupt) the output directory is walked instead
+   **/
+  void deleteStaleFiles(const TSet<FString>& inTouchedFiles) {
+    auto& fileMan = IFileManager::Get();
+    if (m_manifest.isLoaded()) {
+      FString root = m_outPath;
+      FPaths::MakeStandardFilename(root);
+      TArray<FString> files;
+      m_manifest.getFilesUnder(root, files);
+      for (auto& file : files) {
+        if (!inTouchedFiles.Contains(file)) {
+          // the manifest has standard filenames, which may be relative to the base dir
+          FString fullPath = FPaths::ConvertRelativePathToFull(file);
+          LOG("Deleting uneeded file %s", *fullPath);
+          // it's fine if the file was already deleted by hand
+          if (!fileMan.Delete(*fullPath, false, true, true)) {
+            UE_LOG(LogHaxeExtern, Warning, TEXT("Error while deleting file %s"), *fullPath);
+          }
+          m_manifest.remove(file);
+          m_changes.removeFile(file);
+        }
+      }
+      return;
+    }
+
+    class FDeleteVisitor : public IPlatformFile::FDirectoryVisitor {
+    public:
+      const TSet<FString>& m_touchedFiles;
+      FHaxeOutputManifest& m_manifest;
+      FHaxeChangeList& m_changes;
+      FDeleteVisitor(const TSet<FString>& touchedFiles, FHaxeOutputManifest& manifest, FHaxeChangeList& changes) :
+        m_touchedFiles(touchedFiles), m_manifest(manifest), m_changes(changes) {
+      }
+
+      virtual bool Visit(const TCHAR* filename, bool isDir) override {
+        if (isDir) {
+          return true;
+        }
+        FString file = FString(filename);
+        FPaths::MakeStandardFilename(file);
+        if (!m_touchedFiles.Contains(file)) {
+          auto& fileMan = IFileManager::Get();
+          LOG("Deleting uneeded file %s", *filename);
+          if (!fileMan.Delete(filename, true, true, true)) {
+            UE_LOG(LogHaxeExtern, Warning, TEXT("Error while deleting file %s"), filename);
+          }
+          m_manifest.remove(file);
+          m_changes.removeFile(file);
+        }
+        return true;
+      }
+    };
+    FDeleteVisitor visitor(inTouchedFiles, m_manifest, m_changes);
+    fileMan.IterateDirectoryRecursively(*this->m_outPath, visitor);
+  }
+
+  /**
+   * Deletes the temporary files left behind by a run that didn't finish (see `FHaxeFileSink`). They're never in the
+   * manifest, so they must be looked for. Must only be called once every file was written, and only when a run may
+   * have left them behind (see `FinishExport`), as it walks the whole output directory
+   **/
+  void deleteTempFiles() {
+    auto& fileMan = IFileManager::Get();
+    TArray<FString> files;
+    fileMan.FindFilesRecursive(files, *m_outPath, TEXT("*.hx.tmp"), true, false);
+    for (auto& file : files) {
+      LOG("Deleting leftover temporary file %s", *file);
+      if (!fileMan.Delete(*file, false, true, true)) {
+        UE_LOG(LogHaxeExtern, Warning, TEXT("Error while deleting file %s"), *file);
+      }
+    }
+  }
+
+  /**
+   * Deletes the standalone files that the bundled types `inBundled` had before they were bundled.
+   * Only files we wrote ourselves (i.e. that are in the manifest) are deleted
+   **/
+  void deleteUnbundledFiles(const TArray<int32>& inBundled, const TSet<FString>& inTouchedFiles) {
+    auto& fileMan = IFileManager::Get();
+    for (int32 id : inBundled) {
+      const auto& haxeType = m_types.getType(id).getHaxeType();
+      FString file = m_outPath / haxeType.getPackagePath() / haxeType.getName() + TEXT(".hx");
+      FPaths::MakeStandardFilename(file);
+      if (m_manifest.contains(file) && !inTouchedFiles.Contains(file)) {
+        FString fullPath = FPaths::ConvertRelativePathToFull(file);
+        LOG("Deleting uneeded file %s", *fullPath);
+        if (!fileMan.Delete(*fullPath, false, true, true)) {
+          UE_LOG(LogHaxeExtern, Warning, TEXT("Error while deleting file %s"), *fullPath);
+        }
+        m_manifest.remove(file);
+        m_changes.removeFile(file);
+      }
+    }
+  }
+
+  /**
+   * Deletes the bundles of the modules we generated that weren't written by this run, e.g. because `EXTERN_BUNDLE`
+   * was turned off or changed. Only files we wrote ourselves (i.e. that are in the manifest) are deleted
+   **/
+  void deleteStaleBundles(const TSet<FString>& inTouchedFiles) {
+    TMap<const FHaxePackage *, TSet<UPackage *>> packages;
+    for (int32 id = 0; id < m_types.getNumTypes(); id++) {
+      const auto& entry = m_types.getType(id);
+      if (entry.exported && entry.shouldGenerate(true)) {
+        packages.FindOrAdd(entry.getHaxeType().getPackage()).Add(entry.getPackage());
+      }
+    }
+    // the UE modules we generated, by the directory their bundles would be in
+    TMap<FString, TSet<FString>> modulesByDir;
+    for (auto& pair : packages) {
+      FString dir = m_outPath / pair.Key->path;
+      FPaths::MakeStandardFilename(dir);
+      auto& modules = modulesByDir.FindOrAdd(dir);
+      for (UPackage *package : pair.Value) {
+        modules.Add(FPackageName::GetShortName(package));
+      }
+    }
+
+    auto& fileMan = IFileManager::Get();
+    FString root = m_outPath;
+    FPaths::MakeStandardFilename(root);
+    TArray<FString> files;
+    m_manifest.getFilesUnder(root, files);
+    for (auto& file : files) {
+      if (inTouchedFiles.Contains(file)) {
         continue;
       }
-      if (UField* cls = Cast<UField>(obj)) {
-        if (UScriptStruct* ustruct = Cast<UScriptStruct>(cls)) {
-          m_types.touchStruct(ustruct, nullptr);
-        } else if (UEnum* uenum = Cast<UEnum>(cls)) {
-          m_types.touchEnum(uenum, nullptr);
-        } else if (UFunction* ufunc = Cast<UFunction>(cls)) {
-          if ((ufunc->FunctionFlags & FUNC_Delegate) != 0) {
-            m_types.touchDelegate(ufunc, nullptr);
+      auto modules = modulesByDir.Find(FPaths::GetPath(file));
+      if (modules == nullptr) {
+        continue;
+      }
+      FString haxeModule = FPaths::GetBaseFilename(file);
+      for (auto& module : *modules) {
+        if (FHaxeBundler::isBundle(haxeModule, module)) {
+          FString fullPath = FPaths::ConvertRelativePathToFull(file);
+          LOG("Deleting uneeded file %s", *fullPath);
+          if (!fileMan.Delete(*fullPath, false, true, true)) {
+            UE_LOG(LogHaxeExtern, Warning, TEXT("Error while deleting file %s"), *fullPath);
           }
+          m_manifest.remove(file);
+          m_changes.removeFile(file);
+          break;
         }
       }
     }
+  }
 
-    TSet<FString> appendModules;
-    for (auto& udelegate : m_types.getAllDelegates()) {
-      if (!udelegate->haxeType.haxeModule.IsEmpty()) {
-        FString name = FString::Join(udelegate->haxeType.pack, TEXT(".")) + TEXT(".") + udelegate->haxeType.name;
-        appendModules.Add(name);
+  /**
+   * Stops exporting the delegates that failed to generate. Delegates are generated in parallel, so the ones that use
+   * a delegate that failed were generated while it still existed: they're generated again without it (and may fail
+   * in turn) until no more delegates fail, so that no type is ever generated against a delegate that was removed
+   **/
+  void removeFailedDelegates(TArray<FGenResult>& refResults) {
+    TSet<int32> failed;
+    for (auto udelegate : m_types.getAllDelegates()) {
+      if (refResults[udelegate->id].state == EGenResult::Failed) {
+        failed.Add(udelegate->id);
       }
     }
+    if (failed.Num() == 0) {
+      return;
+    }
 
-    for (auto& cls : m_types.getAllClasses()) {
-      if (!cls->haxeType.haxeModule.IsEmpty()) {
-        FString name = FString::Join(cls->haxeType.pack, TEXT(".")) + TEXT(".") + cls->haxeType.name;
-        appendModules.Add(name);
+    FHaxeStatsScope scope(m_stats, TEXT("regenerate delegates"));
+    scope.count = 0;
+    // the dependencies must be found before the delegates are removed, as removed delegates can't be looked up
+    TMap<int32, TArray<int32>> dependencies;
+    for (auto udelegate : m_types.getAllDelegates()) {
+      if (refResults[udelegate->id].state == EGenResult::Generated) {
+        m_types.getDependencies(m_types.getType(udelegate->id), dependencies.Add(udelegate->id));
       }
     }
 
-    for (auto& s : m_types.getAllStructs()) {
-      if (!s->haxeType.haxeModule.IsEmpty()) {
-        FString name = FString::Join(s->haxeType.pack, TEXT(".")) + TEXT(".") + s->haxeType.name;
-        appendModules.Add(name);
+    while (failed.Num() > 0) {
+      for (int32 id : failed) {
+        m_types.doNotExportDelegate(m_types.getType(id).udelegate);
       }
+      // the types that referenced the delegates that were just removed must be resolved again
+      m_typeStrings.reset();
+
+      TSet<int32> newlyFailed;
+      for (auto& pair : dependencies) {
+        auto& result = refResults[pair.Key];
+        if (result.state != EGenResult::Generated) {
+          continue;
+        }
+        bool usesFailed = false;
+        for (int32 dep : pair.Value) {
+          if (failed.Contains(dep)) {
+            usesFailed = true;
+            break;
+          }
+        }
+        if (!usesFailed) {
+          continue;
+        }
+
+        result = FGenResult();
+        generateType(m_types.getType(pair.Key).udelegate, &FHaxeGenerator::generateDelegate, result);
+        scope.count++;
+        if (useGenerationCache()) {
+          FHaxeCachedType cached;
+          cached.fingerprint = result.fingerprint;
+          cached.generated = result.state == EGenResult::Generated;
+          cached.contents = result.contents;
+          m_cache.add(result.cacheKey, cached);
+        }
+        if (result.state == EGenResult::Failed) {
+          newlyFailed.Add(pair.Key);
+        }
+      }
+      failed = MoveTemp(newlyFailed);
     }
+  }
 
-    for (auto& uenum : m_types.getAllEnums()) {
-      if (!uenum->haxeType.haxeModule.IsEmpty()) {
-        FString name = FString::Join(uenum->haxeType.pack, TEXT(".")) + TEXT(".") + uenum->haxeType.name;
-        appendModules.Add(name);
+  template<typename T>
+  void saveAll(const TArray<const T *>& inTypes, TArray<FGenResult>& inResults, TSet<FString>& refTouched, TSet<FString>& refAppend) {
+    for (auto type : inTypes) {
+      auto& result = inResults[type->id];
+      if (result.state == EGenResult::Generated) {
+        saveFile(type->haxeType, MoveTemp(result.contents), refTouched, refAppend);
+      }
+    }
+  }
+
+  /** Called once all classes have been exported */
+  virtual void FinishExport() override {
+    m_changes.begin(m_manifest);
+    if (useReachableOnly()) {
+      // the types that weren't touched by any class can't be reached, so there's no need to sweep for them
+      FHaxeStatsScope scope(m_stats, TEXT("reachability"));
+      scope.count = m_types.exportOnlyReachable(
+        [](const FHaxeTypeEntry& inEntry) {
+          return inEntry.isClass() && inEntry.shouldGenerate();
+        },
+        [](const FHaxeTypeEntry& inEntry) {
+          return inEntry.shouldGenerate(true);
+        });
+    } else {
+      // find the structs, enums and delegates that weren't referenced by any class. Only the packages of the modules
+      // we generate can have them, so we only look at their objects
+      FHaxeStatsScope scope(m_stats, TEXT("sweep"));
+      scope.count = 0;
+      TArray<UObject *> packages;
+      GetObjectsOfClass(UPackage::StaticClass(), packages, false);
+      for (UObject *pack : packages) {
+        if (!HaxeTypeHelpers::getPackageInfo(static_cast<UPackage *>(pack)).shouldGenerate(true)) {
+          continue;
+        }
+        ForEachObjectWithOuter(pack, [&](UObject *obj) {
+          scope.count++;
+          if (UScriptStruct* ustruct = Cast<UScriptStruct>(obj)) {
+            m_types.touchStruct(ustruct, nullptr);
+          } else if (UEnum* uenum = Cast<UEnum>(obj)) {
+            m_types.touchEnum(uenum, nullptr);
+          } else if (UFunction* ufunc = Cast<UFunction>(obj)) {
+            if ((ufunc->FunctionFlags & FUNC_Delegate) != 0) {
+              m_types.touchDelegate(ufunc, nullptr);
+            }
+          }
+        }, true, RF_ClassDefaultObject);
       }
     }
 
+    if (!m_snapshotPath.IsEmpty()) {
+      // every type is known at this point, and nothing was changed yet by the generator (e.g. by bundling)
+      FHaxeStatsScope scope(m_stats, TEXT("snapshot"));
+      m_snapshot.save(m_types, m_snapshotPath);
+    }
+
+    // bundled types are saved like the ones that set `HaxeModule`, so this must be done before `appendModules` is built
+    TArray<int32> bundled;
+    if (m_bundler.isEnabled()) {
+      FHaxeStatsScope scope(m_stats, TEXT("bundle"));
+      m_bundler.assign(m_types, bundled);
+      scope.count = bundled.Num();
+    }
 
-    TSet<FString> touchedFiles;
-    // now start generating
+    TSet<FString> appendModules;
     for (auto& udelegate : m_types.getAllDelegates()) {
-      if (!HaxeTypeHelpers::shouldGenerateModule(udelegate->haxeType.module, true)) {
-        continue;
-      }
-      auto gen = FHaxeGenerator(this->m_types);
-      if (gen.generateDelegate(udelegate)) {
-        FString genString = gen.toString();
-        saveFile(udelegate->haxeType, genString, touchedFiles, appendModules);
-      } else {
-        m_types.doNotExportDelegate(udelegate);
+      if (!udelegate->haxeType.getHaxeModule().IsEmpty()) {
+        appendModules.Add(udelegate->haxeType.getTypePath());
       }
     }
 
     for (auto& cls : m_types.getAllClasses()) {
-      if (!HaxeTypeHelpers::shouldGenerateModule(cls->haxeType.module, true)) {
-        continue;
+      if (!cls->haxeType.getHaxeModule().IsEmpty()) {
+        appendModules.Add(cls->haxeType.getTypePath());
       }
-      auto gen = FHaxeGenerator(this->m_types);
-      gen.generateClass(cls);
-      FString genString = gen.toString();
-      saveFile(cls->haxeType, genString, touchedFiles, appendModules);
     }
 
     for (auto& s : m_types.getAllStructs()) {
-      if (!HaxeTypeHelpers::shouldGenerateModule(s->haxeType.module, true)) {
-        continue;
+      if (!s->haxeType.getHaxeModule().IsEmpty()) {
+        appendModules.Add(s->haxeType.getTypePath());
       }
-      auto gen = FHaxeGenerator(this->m_types);
-      gen.generateStruct(s);
-      FString genString = gen.toString();
-      saveFile(s->haxeType, genString, touchedFiles, appendModules);
     }
 
     for (auto& uenum : m_types.getAllEnums()) {
-      if (!HaxeTypeHelpers::shouldGenerateModule(uenum->haxeType.module, true)) {
-        continue;
+      if (!uenum->haxeType.getHaxeModule().IsEmpty()) {
+        appendModules.Add(uenum->haxeType.getTypePath());
       }
-      auto gen = FHaxeGenerator(this->m_types);
-      gen.generateEnum(uenum);
-      FString genString = gen.toString();
-      saveFile(uenum->haxeType, genString, touchedFiles, appendModules);
     }
 
-    for (auto partialsIt = m_partialFiles.CreateIterator() ; partialsIt; ++partialsIt) {
-      saveFile(partialsIt.Key(), partialsIt.Value(), false);
-    }
 
-    if (HaxeTypeHelpers::compilingGameCode()) {
-      class FDeleteVisitor : public IPlatformFile::FDirectoryVisitor {
-      public:
-        TSet<FString> m_touchedFiles;
-        FDeleteVisitor(TSet<FString> touchedFiles) : m_touchedFiles(touchedFiles) {
-        }
+    // a run that stops while writing leaves its temporary files behind. The marker is only deleted once every file
+    // was written, so we only need to look for them if it's still there, or if the manifest was lost
+    FString writingMarker = getOutputSidePath(TEXT(".writing"));
+    bool sweepTempFiles = !m_manifest.isLoaded() || IFileManager::Get().FileExists(*writingMarker);
+    FFileHelper::SaveStringToFile(FString(), *writingMarker);
 
-        virtual bool Visit(const TCHAR* filename, bool isDir) override {
-          if (isDir) {
-            return true;
-          }
-          FString file = FString(filename);
-          FPaths::MakeStandardFilename(file);
-          if (!m_touchedFiles.Contains(file)) {
-            auto& fileMan = IFileManager::Get();
-            LOG("Deleting uneeded file %s", *filename);
-            if (!fileMan.Delete(filename, true, true, true)) {
-              UE_LOG(LogHaxeExtern, Warning, TEXT("Error while deleting file %s"), filename);
-            }
-          }
-          return true;
+    TSet<FString> touchedFiles;
+    // now start generating
+    // delegates are generated first, since the ones that fail to generate must be removed
+    // before any other type references them
+    auto genDelegates = generateTypes(true);
+    removeFailedDelegates(genDelegates);
+    {
+      // the files are only queued here. They're compared and written by the workers (see "write")
+      FHaxeStatsScope scope(m_stats, TEXT("queue writes"));
+      for (auto udelegate : m_types.getAllDelegates()) {
+        auto& result = genDelegates[udelegate->id];
+        if (result.state == EGenResult::Generated) {
+          saveFile(udelegate->haxeType, MoveTemp(result.contents), touchedFiles, appendModules);
         }
-      };
-      FDeleteVisitor visitor(touchedFiles);
-      auto& fileMan = IFileManager::Get();
-      fileMan.IterateDirectoryRecursively(*this->m_outPath, visitor);
+      }
+      scope.count = touchedFiles.Num();
+    }
+
+    auto genTypes = generateTypes(false);
+    // saving is kept serial and in a fixed order, so that the files that are appended to
+    // (`haxeModule`) end up with the same contents as a serial run
+    {
+      FHaxeStatsScope scope(m_stats, TEXT("queue writes"));
+      int32 numTouched = touchedFiles.Num();
+      saveAll(m_types.getAllClasses(), genTypes, touchedFiles, appendModules);
+      saveAll(m_types.getAllStructs(), genTypes, touchedFiles, appendModules);
+      saveAll(m_types.getAllEnums(), genTypes, touchedFiles, appendModules);
+
+      for (auto partialsIt = m_partialFiles.CreateIterator() ; partialsIt; ++partialsIt) {
+        saveFile(partialsIt.Key(), partialsIt.Value().module, FString(), MoveTemp(partialsIt.Value().contents), false);
+      }
+      m_partialFiles.Reset();
+      scope.count = touchedFiles.Num() - numTouched;
+    }
+    {
+      // every file must be written before we can look for the ones that weren't touched
+      FHaxeStatsScope scope(m_stats, TEXT("drain writes"));
+      FString error;
+      if (!m_writeQueue.drain(error)) {
+        UE_LOG(LogHaxeExtern, Fatal, TEXT("%s"), *error);
+      }
+    }
+    for (auto& time : m_writeTimes) {
+      m_stats.addWork(TEXT("write"), time.file, time.start, time.end, time.threadId);
+    }
+    m_writeTimes.Reset();
+    for (auto& fileTypes : m_fileTypes) {
+      m_manifest.setTypes(fileTypes.Key, fileTypes.Value);
     }
+
+    if (HaxeTypeHelpers::compilingGameCode()) {
+      FHaxeStatsScope scope(m_stats, TEXT("delete"));
+      deleteStaleFiles(touchedFiles);
+    } else {
+      // engine runs don't look for stale files, but the files of the types that were just bundled are known,
+      // and so are the bundles of the modules we generated
+      FHaxeStatsScope scope(m_stats, TEXT("delete"));
+      if (bundled.Num() > 0) {
+        deleteUnbundledFiles(bundled, touchedFiles);
+      }
+      deleteStaleBundles(touchedFiles);
+    }
+    if (sweepTempFiles) {
+      FHaxeStatsScope scope(m_stats, TEXT("delete temporary files"));
+      deleteTempFiles();
+    }
+    IFileManager::Get().Delete(*writingMarker, false, true, true);
+    if (useTypeDatabase()) {
+      FHaxeStatsScope scope(m_stats, TEXT("type database"));
+      FHaxeTypeDatabase db;
+      auto gen = m_generators.acquire();
+      db.build(m_types, *gen);
+      m_generators.release(gen);
+      db.save(getOutputSidePath(TEXT(".typedb")));
+    }
+    {
+      FHaxeStatsScope scope(m_stats, TEXT("dependency graph"));
+      FHaxeDependencyGraph graph;
+      graph.build(m_types);
+      graph.save(m_types, getOutputSidePath(TEXT("-dependencies.json")));
+    }
+    {
+      FHaxeStatsScope scope(m_stats, TEXT("save manifest and cache"));
+      m_manifest.save();
+      if (useGenerationCache()) {
+        m_cache.save();
+      }
+    }
+    m_changes.save(getOutputSidePath(TEXT("-changes.json")), m_manifest);
+    m_stats.save(getOutputSidePath(TEXT("-stats.json")), getOutputSidePath(TEXT("-trace.json")), SlowestTypesInStats);
     // auto outPath = this->m_outPath / FString::Join(inHaxeType.pack, TEXT("/"));
     // if (!fileMan.DirectoryExists(*outPath)) {
     //   fileMan.MakeDirectory(*outPath, true);
@@ -338,11 +911,11 @@ static TArray<FString> getUFunctionFlags(UFunction *func) {
 
 static TArray<FString> getUPropertyFlags(UProperty *prop) {
   TArray<FString> ret;
-  auto& getter = prop->GetMetaData(TEXT("BlueprintGetter"));
+  auto& getter = prop->GetMetaData(FHaxeMetaKeys::get().BlueprintGetter);
   if (!getter.IsEmpty()) {
     ret.Push(FString(TEXT("BlueprintGetter=")) + getter);
   }
-  auto& setter = prop->GetMetaData(TEXT("BlueprintSetter"));
+  auto& setter = prop->GetMetaData(FHaxeMetaKeys::get().BlueprintSetter);
   if (!setter.IsEmpty()) {
     ret.Push(FString(TEXT("BlueprintSetter=")) + setter);
   }
@@ -434,7 +1007,7 @@ void FHaxeGenerator::generateFields(UStruct *inStruct, bool onlyProps = false) {
           }
           wasEditorOnlyData = isEditorOnlyData;
         }
-        auto& propComment = prop->GetMetaData(TEXT("ToolTip"));
+        auto& propComment = prop->GetMetaData(FHaxeMetaKeys::get().ToolTip);
         if (!propComment.IsEmpty()) {
           m_buf << Comment(propComment);
         }
@@ -464,7 +1037,7 @@ void FHaxeGenerator::generateFields(UStruct *inStruct, bool onlyProps = false) {
         continue;
       }
       LOG("Starting to generate %s (flags %x)", *func->GetName(), (int) func->FunctionFlags);
-      if (this->m_generatedFields.Contains(func->GetName())) {
+      if (this->isFieldGenerated(func->GetFName())) {
         LOG("continuing %s %s", *uclass->GetName(), *func->GetOwnerClass()->GetName());
         // we don't need to generate overridden functions' glue code
         continue;
@@ -487,10 +1060,11 @@ void FHaxeGenerator::generateFields(UStruct *inStruct, bool onlyProps = false) {
         wasEditorOnly = isEditorOnly;
       }
 
-      this->m_generatedFields.Add(func->GetName());
-      // we need to create a local buffer because we will only know if we should
+      this->m_generatedFields.Add(func->GetFName());
+      // we need to use a separate buffer because we will only know if we should
       // generate this function in the end of its processing
-      FHelperBuf curBuf;
+      FHelperBuf& curBuf = m_funcBuf;
+      curBuf.reset();
 
       curBuf << TEXT("@:ufunction");
       auto flags = getUFunctionFlags(func);
@@ -513,6 +1087,7 @@ void FHaxeGenerator::generateFields(UStruct *inStruct, bool onlyProps = false) {
       auto first = true;
       auto shouldExport = true;
       bool hasReturnValue = false;
+      auto funcMeta = UMetaData::GetMapForObject(func);
       for (TFieldIterator<UProperty> params(func); params; ++params) {
         check(!hasReturnValue);
         auto param = *params;
@@ -524,7 +1099,9 @@ void FHaxeGenerator::generateFields(UStruct *inStruct, bool onlyProps = false) {
           } else {
             if (first) first = false; else curBuf << TEXT(", ");
             bool escapeDefault = false;
-            auto defaultValue = func->GetMetaData(*(FString(TEXT("CPP_Default_")) + param->GetName()));
+            auto found = FHaxeMetaKeys::findComposite(funcMeta, TEXT("CPP_Default_"), param->GetName(), TEXT(""));
+            FString defaultValue = found != nullptr ? *found : FString();
+            const FString *bpDefault = nullptr;
             if (!defaultValue.IsEmpty()) {
               if (param->IsA<UNumericProperty>()
                   || param->IsA<UBoolProperty>()
@@ -537,9 +1114,8 @@ void FHaxeGenerator::generateFields(UStruct *inStruct, bool onlyProps = false) {
                 curBuf << TEXT("@:opt(\"") << Escaped(defaultValue) << TEXT("\") ");
                 defaultValue = FString();
               }
-            } else if ( !( (defaultValue = func->GetMetaData(*param->GetName())).IsEmpty() ) ) {
-              curBuf << TEXT("@:bpopt(\"") << Escaped(defaultValue) << TEXT("\") ");
-              defaultValue = FString();
+            } else if (funcMeta != nullptr && (bpDefault = funcMeta->Find(param->GetFName())) != nullptr && !bpDefault->IsEmpty()) {
+              curBuf << TEXT("@:bpopt(\"") << Escaped(*bpDefault) << TEXT("\") ");
             }
             curBuf << param->GetNameCPP() << TEXT(" : ") << type;
             if (!defaultValue.IsEmpty()) {
@@ -567,7 +1143,7 @@ void FHaxeGenerator::generateFields(UStruct *inStruct, bool onlyProps = false) {
           wasEditorOnlyData = false;
           m_buf << TEXT("#end // WITH_EDITORONLY_DATA") << Newline();
         }
-        auto& fnComment = func->GetMetaData(TEXT("ToolTip"));
+        auto& fnComment = func->GetMetaData(FHaxeMetaKeys::get().ToolTip);
         if (!fnComment.IsEmpty()) {
           m_buf << Comment(fnComment);
         }
@@ -587,23 +1163,56 @@ void FHaxeGenerator::generateFields(UStruct *inStruct, bool onlyProps = false) {
   }
 }
 
-void FHaxeGenerator::collectSuperFields(UStruct *inSuper) {
-  for (TFieldIterator<UField> fields(inSuper, EFieldIteratorFlags::IncludeSuper); fields; ++fields) {
-    auto field = *fields;
-    this->m_generatedFields.Add(field->GetName());
+void FHaxeGenerator::reserveFor(UStruct *inStruct) {
+  // rough estimate of the generated size, so the buffer doesn't need to grow over and over
+  int32 size = 1024;
+  for (TFieldIterator<UField> fields(inStruct, EFieldIteratorFlags::ExcludeSuper); fields; ++fields) {
+    size += 192;
   }
+  m_buf.reserve(size);
+}
+
+const FHaxeFieldNames *FHaxeFieldNameCache::get(UStruct *inStruct) {
+  if (inStruct == nullptr) {
+    return nullptr;
+  }
+  m_lock.ReadLock();
+  const FHaxeFieldNames *found = m_nodes.FindRef(inStruct);
+  m_lock.ReadUnlock();
+  if (found != nullptr) {
+    return found;
+  }
+
+  const FHaxeFieldNames *super = get(inStruct->GetSuperStruct());
+  TSet<FName> names;
+  for (TFieldIterator<UField> fields(inStruct, EFieldIteratorFlags::ExcludeSuper); fields; ++fields) {
+    names.Add(fields->GetFName());
+  }
+
+  m_lock.WriteLock();
+  // another thread may have added it in the meantime
+  found = m_nodes.FindRef(inStruct);
+  if (found == nullptr) {
+    FHaxeFieldNames *node = m_arena.create(super);
+    node->names = MoveTemp(names);
+    m_nodes.Add(inStruct, node);
+    found = node;
+  }
+  m_lock.WriteUnlock();
+  return found;
 }
 
 bool FHaxeGenerator::generateClass(const ClassDescriptor *inClass) {
-  auto hxType = inClass->haxeType;
+  const auto& hxType = inClass->haxeType;
 
   auto isInterface = hxType.kind == ETypeKind::KUInterface;
   auto uclass = inClass->uclass;
+  this->reserveFor(uclass);
   bool isNoExport = (uclass->ClassFlags & CLASS_NoExport) != 0;
   bool isMinimalAPI = (uclass->ClassFlags & CLASS_MinimalAPI) != 0;
   auto shouldNotExport = isMinimalAPI || (!uclass->HasAnyClassFlags( CLASS_RequiredAPI | CLASS_MinimalAPI ) && !inClass->header.IsEmpty() && uclass->GetName() != TEXT("Object"));
   // comment
-  auto comment = uclass->GetMetaData(TEXT("ToolTip"));
+  auto comment = uclass->GetMetaData(FHaxeMetaKeys::get().ToolTip);
   if (isNoExport) {
     comment = TEXT("WARNING: This type is defined as NoExport by UHT. It will be empty because of it\n\n") + comment;
   }
@@ -620,7 +1229,7 @@ bool FHaxeGenerator::generateClass(const ClassDescriptor *inClass) {
   if (!hxType.module.IsEmpty()) {
     m_buf << TEXT("@:umodule(\"") << Escaped(hxType.module) << TEXT("\")") << Newline();
   }
-  if (!hxType.uname.IsEmpty() && hxType.uname != hxType.name) {
+  if (!hxType.uname.IsEmpty() && hxType.uname != hxType.getName()) {
     m_buf << TEXT("@:uname(\"") << Escaped(hxType.uname) << TEXT("\")") << Newline();
   }
   if (hxType.haxeGenerated) {
@@ -632,7 +1241,7 @@ bool FHaxeGenerator::generateClass(const ClassDescriptor *inClass) {
     m_buf << TEXT("@:noClass ");
   }
 
-  m_buf << TEXT("@:uextern @:uclass extern ") << (isInterface ? TEXT("interface ") : TEXT("class ")) << hxType.name;
+  m_buf << TEXT("@:uextern @:uclass extern ") << (isInterface ? TEXT("interface ") : TEXT("class ")) << hxType.getName();
   if (!isInterface) {
     auto superUClass = uclass->GetSuperClass();
     const ClassDescriptor *super = nullptr;
@@ -649,7 +1258,7 @@ bool FHaxeGenerator::generateClass(const ClassDescriptor *inClass) {
       }
 
       if (super != nullptr) {
-        this->collectSuperFields(superUClass);
+        m_superFields = m_fieldNames->get(superUClass);
         m_buf << " extends " << super->haxeType.toString();
       }
     }
@@ -690,10 +1299,10 @@ void FHaxeGenerator::generateIncludeMetas(const NonClassDescriptor *inDesc) {
 }
 
 bool FHaxeGenerator::generateDelegate(const DelegateDescriptor *inDelegate) {
-  auto hxType = inDelegate->haxeType;
+  const auto& hxType = inDelegate->haxeType;
   auto udelegate = inDelegate->delegateSignature;
   FHelperBuf commentBuf;
-  commentBuf << udelegate->GetMetaData(TEXT("ToolTip"));
+  commentBuf << udelegate->GetMetaData(FHaxeMetaKeys::get().ToolTip);
   commentBuf.newLineIfNeeded();
   FHelperBuf paramNames;
   FHelperBuf curBuf;
@@ -708,20 +1317,20 @@ bool FHaxeGenerator::generateDelegate(const DelegateDescriptor *inDelegate) {
     auto ustructOuter = Cast<UStruct>(outer);
     uname = ustructOuter->GetPrefixCPP() + ustructOuter->GetName() + TEXT(".") + uname;
   }
-  if (!uname.IsEmpty() && uname != hxType.name) {
+  if (!uname.IsEmpty() && uname != hxType.getName()) {
     curBuf << TEXT("@:uname(\"") << Escaped(uname) << TEXT("\")") << Newline();
   }
   if (hxType.haxeGenerated) {
     curBuf << TEXT("@:haxeGenerated") << Newline();
   }
 
-  curBuf << TEXT("typedef ") << hxType.name << TEXT(" = ");
+  curBuf << TEXT("typedef ") << hxType.getName() << TEXT(" = ");
   if ((udelegate->FunctionFlags & FUNC_MulticastDelegate) == 0) {
     curBuf << TEXT("unreal.DynamicDelegate<");
   } else {
     curBuf << TEXT("unreal.DynamicMulticastDelegate<");
   }
-  curBuf << hxType.name << TEXT(", ");
+  curBuf << hxType.getName() << TEXT(", ");
 
   auto first = true;
   auto shouldExport = true;
@@ -750,7 +1359,7 @@ bool FHaxeGenerator::generateDelegate(const DelegateDescriptor *inDelegate) {
     first = false;
   }
   if (!shouldExport) {
-    LOG("Could not generate delegate %s", *hxType.name);
+    LOG("Could not generate delegate %s", *hxType.getName());
     return false;
   } else {
     if (!hasReturnValue) {
@@ -773,13 +1382,14 @@ bool FHaxeGenerator::generateDelegate(const DelegateDescriptor *inDelegate) {
 }
 
 bool FHaxeGenerator::generateStruct(const StructDescriptor *inStruct) {
-  auto hxType = inStruct->haxeType;
+  const auto& hxType = inStruct->haxeType;
 
   auto ustruct = inStruct->ustruct;
+  this->reserveFor(ustruct);
   // comment
   bool isNoExport = (ustruct->StructFlags & STRUCT_NoExport) != 0;
   auto isNotRequired = (ustruct->StructFlags & STRUCT_RequiredAPI) == 0;
-  auto comment = ustruct->GetMetaData(TEXT("ToolTip"));
+  auto comment = ustruct->GetMetaData(FHaxeMetaKeys::get().ToolTip);
   if (isNoExport) {
     comment = TEXT("WARNING: This type is defined as NoExport by UHT. It will be empty because of it\n\n") + comment;
   }
@@ -791,7 +1401,7 @@ bool FHaxeGenerator::generateStruct(const StructDescriptor *inStruct) {
   if (!hxType.module.IsEmpty()) {
     m_buf << TEXT("@:umodule(\"") << Escaped(hxType.module) << TEXT("\")") << Newline();
   }
-  if (!hxType.uname.IsEmpty() && hxType.uname != hxType.name) {
+  if (!hxType.uname.IsEmpty() && hxType.uname != hxType.getName()) {
     m_buf << TEXT("@:uname(\"") << Escaped(hxType.uname) << TEXT("\")") << Newline();
   }
   if (hxType.haxeGenerated) {
@@ -801,14 +1411,14 @@ bool FHaxeGenerator::generateStruct(const StructDescriptor *inStruct) {
   generateIncludeMetas(inStruct);
   auto ops = inStruct->ustruct->GetCppStructOps();
   bool isAbstract = ops != nullptr ? ops->IsAbstract() : false;
-  if (isAbstract || isNotRequired ||!structHasCopy(inStruct->ustruct)) {
+  if (isAbstract || isNotRequired || !FHaxeGeneratorConfig::get().structHasCopy(inStruct->ustruct)) {
     // we don't know if == or the copy constructors are inline or not
     m_buf << TEXT("@:noCopy ");
   }
   if (isAbstract || isNotRequired || (ops != nullptr && !ops->HasIdentical())) {
     m_buf << TEXT("@:noEquals ");
   }
-  m_buf << TEXT("@:uextern @:ustruct extern ") << TEXT("class ") << hxType.name;
+  m_buf << TEXT("@:uextern @:ustruct extern ") << TEXT("class ") << hxType.getName();
 
   auto superStruct = ustruct->GetSuperStruct();
   const StructDescriptor *super = nullptr;
@@ -838,12 +1448,15 @@ bool FHaxeGenerator::generateStruct(const StructDescriptor *inStruct) {
 
 bool FHaxeGenerator::generateEnum(const EnumDescriptor *inEnum) {
   auto uenum = inEnum->uenum;
-  auto hxType = inEnum->haxeType;
+  const auto& hxType = inEnum->haxeType;
+  m_buf.reserve(1024 + uenum->NumEnums() * 64);
 
+  // `UEnum` hides the `FName` overloads of `GetMetaData`, so its metadata is looked up in its map directly
+  auto enumMeta = UMetaData::GetMapForObject(uenum);
   // comment
-  auto comment = uenum->GetMetaData(TEXT("ToolTip"));
-  if (!comment.IsEmpty()) {
-    m_buf << Comment(comment);
+  auto comment = enumMeta != nullptr ? enumMeta->Find(FHaxeMetaKeys::get().ToolTip) : nullptr;
+  if (comment != nullptr && !comment->IsEmpty()) {
+    m_buf << Comment(*comment);
   }
   // @:umodule
   if (!hxType.module.IsEmpty()) {
@@ -860,13 +1473,15 @@ bool FHaxeGenerator::generateEnum(const EnumDescriptor *inEnum) {
     m_buf << TEXT("@:class ");
   }
 
-  m_buf << TEXT("@:uextern @:uenum extern ") << TEXT("enum ") << hxType.name;
+  m_buf << TEXT("@:uextern @:uenum extern ") << TEXT("enum ") << hxType.getName();
 
   m_buf << Begin(TEXT(" {"));
   for (int i = 0; i < uenum->NumEnums(); i++) {
     auto name = uenum->GetNameStringByIndex(i);
-    auto ecomment = uenum->GetMetaData(*(name + TEXT(".") + TEXT("ToolTip")));
-    auto displayName = uenum->GetMetaData(*(name + TEXT(".") + TEXT("DisplayName")));
+    auto found = FHaxeMetaKeys::findComposite(enumMeta, TEXT(""), name, TEXT(".ToolTip"));
+    FString ecomment = found != nullptr ? *found : FString();
+    found = FHaxeMetaKeys::findComposite(enumMeta, TEXT(""), name, TEXT(".DisplayName"));
+    FString displayName = found != nullptr ? *found : FString();
     if (!displayName.IsEmpty()) {
       if (ecomment.IsEmpty()) {
         ecomment = displayName;
@@ -946,10 +1561,8 @@ bool FHaxeGenerator::writeBasicWithModifiers(const FString &inName, UProperty *i
   return true;
 }
 
-static bool canBuildTArrayProp(FString inInner, UProperty *inProp) {
-  // HACK: we need this since some types struggle with some operators (e.g. set operator)
-  //       we'll need to find a better way to deal with this, but for now we'll just not include that into the built
-  if (inInner.Contains(TEXT("FStaticMeshComponentLODInfo"), ESearchCase::CaseSensitive, ESearchDir::FromStart)) {
+static bool canBuildTArrayProp(UProperty *inProp) {
+  if (!FHaxeGeneratorConfig::get().isSupportedElement(inProp)) {
     return false;
   } else if (inProp->IsA<UNumericProperty>() && Cast<UNumericProperty>(inProp)->GetIntPropertyEnum() != nullptr) {
     // TArray<Enum> is not supported because UHT doesn't let us know if the C++ was declared as either TArray<Enum> or TArray<TEnumAsByte<Enum>>
@@ -971,12 +1584,72 @@ bool FHaxeGenerator::isReadOnly(UProperty* inProp) {
     // }
     // return !ops->HasCopy();
     //
-    return !structHasCopy(prop->Struct);
+    return !FHaxeGeneratorConfig::get().structHasCopy(prop->Struct);
   }
   return false;
 }
 
+static void addKeyParts(UProperty *inProp, FPropTypeKey& outKey) {
+  // these are all the flags that `upropType` and `writeWithModifiers` look at
+  static const uint64 relevantFlags = CPF_ReturnParm | CPF_ConstParm | CPF_ReferenceParm | CPF_OutParm | CPF_UObjectWrapper;
+  outKey.parts.Add((UPTRINT) inProp->GetClass());
+  outKey.parts.Add((UPTRINT) (inProp->PropertyFlags & relevantFlags));
+  outKey.parts.Add((UPTRINT) inProp->ArrayDim);
+  if (auto structProp = Cast<UStructProperty>(inProp)) {
+    outKey.parts.Add((UPTRINT) structProp->Struct);
+  } else if (auto classProp = Cast<UClassProperty>(inProp)) {
+    outKey.parts.Add((UPTRINT) classProp->MetaClass);
+    outKey.parts.Add((UPTRINT) classProp->PropertyClass);
+  } else if (auto objProp = Cast<UObjectPropertyBase>(inProp)) {
+    outKey.parts.Add((UPTRINT) objProp->PropertyClass);
+  } else if (auto numeric = Cast<UNumericProperty>(inProp)) {
+    outKey.parts.Add((UPTRINT) numeric->GetIntPropertyEnum());
+  } else if (auto enumProp = Cast<UEnumProperty>(inProp)) {
+    outKey.parts.Add((UPTRINT) enumProp->GetEnum());
+  } else if (auto arrProp = Cast<UArrayProperty>(inProp)) {
+    addKeyParts(arrProp->Inner, outKey);
+  } else if (auto mapProp = Cast<UMapProperty>(inProp)) {
+    addKeyParts(mapProp->KeyProp, outKey);
+    addKeyParts(mapProp->ValueProp, outKey);
+  } else if (auto setProp = Cast<USetProperty>(inProp)) {
+    addKeyParts(setProp->ElementProp, outKey);
+  } else if (auto delProp = Cast<UDelegateProperty>(inProp)) {
+    outKey.parts.Add((UPTRINT) delProp->SignatureFunction);
+  } else if (auto mcDelProp = Cast<UMulticastDelegateProperty>(inProp)) {
+    outKey.parts.Add((UPTRINT) mcDelProp->SignatureFunction);
+  }
+}
+
+FPropTypeKey FPropTypeKey::fromProperty(UProperty *inProp) {
+  FPropTypeKey ret;
+  addKeyParts(inProp, ret);
+  for (auto part : ret.parts) {
+    ret.hash = HashCombine(ret.hash, GetTypeHash(part));
+  }
+  return ret;
+}
+
 bool FHaxeGenerator::upropType(UProperty* inProp, FString &outType) {
+  if (m_typeCache == nullptr) {
+    return resolveUPropType(inProp, outType);
+  }
+
+  auto key = FPropTypeKey::fromProperty(inProp);
+  bool supported = false;
+  if (m_typeCache->find(key, supported, outType)) {
+    return supported;
+  }
+  FString type;
+  supported = resolveUPropType(inProp, type);
+  if (!supported) {
+    type = FString();
+  }
+  m_typeCache->add(key, supported, type);
+  outType += type;
+  return supported;
+}
+
+bool FHaxeGenerator::resolveUPropType(UProperty* inProp, FString &outType) {
   if (inProp->ArrayDim > 1) {
     return false;
   }
@@ -1074,7 +1747,7 @@ bool FHaxeGenerator::upropType(UProperty* inProp, FString &outType) {
     FString inner;
     if (!upropType(prop->Inner, inner))
       return false;
-    return canBuildTArrayProp(inner, prop->Inner) && writeWithModifiers(TEXT("unreal.TArray<") + inner + TEXT(">"), inProp, outType);
+    return canBuildTArrayProp(prop->Inner) && writeWithModifiers(TEXT("unreal.TArray<") + inner + TEXT(">"), inProp, outType);
   } else if (inProp->IsA<UMulticastDelegateProperty>()) {
     auto prop = Cast<UMulticastDelegateProperty>(inProp);
     auto descr = m_haxeTypes.getDescriptor(prop->SignatureFunction);
@@ -1095,14 +1768,14 @@ bool FHaxeGenerator::upropType(UProperty* inProp, FString &outType) {
     FString valProp;
     if (!upropType(prop->KeyProp, keyProp) || !upropType(prop->ValueProp, valProp))
       return false;
-    return canBuildTArrayProp(keyProp, prop->KeyProp) && canBuildTArrayProp(valProp, prop->ValueProp) &&
+    return canBuildTArrayProp(prop->KeyProp) && canBuildTArrayProp(prop->ValueProp) &&
       writeWithModifiers(TEXT("unreal.TMap<") + keyProp + TEXT(", ") + valProp + TEXT(">"), inProp, outType);
   } else if (inProp->IsA<USetProperty>()) {
     auto prop = Cast<USetProperty>(inProp);
     FString element;
     if (!upropType(prop->ElementProp, element))
       return false;
-    return canBuildTArrayProp(element, prop->ElementProp) &&
+    return canBuildTArrayProp(prop->ElementProp) &&
       writeWithModifiers(TEXT("unreal.TSet<") + element + TEXT(">"), inProp, outType);
   }
   // TODO:
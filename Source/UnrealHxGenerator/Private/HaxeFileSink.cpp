@@ -0,0 +1,87 @@
+#include "HaxeFileSink.h"
+#include "HaxeTypes.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#else
+#include <stdio.h>
+#endif
+
+// how many characters are converted to UTF-8 at a time
+static const int32 ChunkSize = 2048;
+
+/**
+ * Moves `inSource` over `inTarget` in a single step, so that the target is never missing.
+ * `IFileManager::Move` can't be used, as it deletes the target before moving the file
+ **/
+static bool replaceFile(const FString& inTarget, const FString& inSource) {
+  FString target = FPaths::ConvertRelativePathToFull(inTarget);
+  FString source = FPaths::ConvertRelativePathToFull(inSource);
+#if PLATFORM_WINDOWS
+  return MoveFileExW(*source, *target, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  return rename(TCHAR_TO_UTF8(*source), TCHAR_TO_UTF8(*target)) == 0;
+#endif
+}
+
+bool FHaxeFileSink::open(const FString& inTarget) {
+  check(m_writer == nullptr);
+  m_target = inTarget;
+  m_temp = inTarget + TEXT(".tmp");
+  m_writer = IFileManager::Get().CreateFileWriter(*m_temp);
+  return m_writer != nullptr;
+}
+
+void FHaxeFileSink::writeUTF8(const ANSICHAR *inData, int32 inLen) {
+  m_sha.Update(reinterpret_cast<const uint8 *>(inData), inLen);
+  m_size += inLen;
+  if (m_writer != nullptr) {
+    m_writer->Serialize(const_cast<ANSICHAR *>(inData), inLen);
+  }
+}
+
+FHaxeFileSink& FHaxeFileSink::write(const TCHAR *inText, int32 inLen) {
+  while (inLen > 0) {
+    int32 len = inLen < ChunkSize ? inLen : ChunkSize;
+    // never split a surrogate pair between two chunks
+    if (len < inLen && inText[len - 1] >= 0xD800 && inText[len - 1] <= 0xDBFF) {
+      len--;
+    }
+    FTCHARToUTF8 utf8(inText, len);
+    writeUTF8(utf8.Get(), utf8.Length());
+    inText += len;
+    inLen -= len;
+  }
+  return *this;
+}
+
+bool FHaxeFileSink::commit() {
+  if (m_writer == nullptr) {
+    return false;
+  }
+  bool ok = m_writer->Close();
+  delete m_writer;
+  m_writer = nullptr;
+  if (!ok) {
+    IFileManager::Get().Delete(*m_temp, false, true, true);
+    return false;
+  }
+
+  if (!replaceFile(m_target, m_temp)) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Cannot move %s to %s"), *m_temp, *m_target);
+    IFileManager::Get().Delete(*m_temp, false, true, true);
+    return false;
+  }
+  return true;
+}
+
+void FHaxeFileSink::discard() {
+  if (m_writer != nullptr) {
+    m_writer->Close();
+    delete m_writer;
+    m_writer = nullptr;
+    IFileManager::Get().Delete(*m_temp, false, true, true);
+  }
+}
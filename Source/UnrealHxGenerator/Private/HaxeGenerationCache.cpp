@@ -0,0 +1,307 @@
+#include "HaxeGenerationCache.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// increment this whenever a change to the generator changes its output. The hash of the generator sources
+// (computed by UnrealHxGenerator.Build.cs) also invalidates the cache, but only for builds made from changed sources
+static const int32 CacheVersion = 2;
+
+#ifndef UHX_GENERATOR_SOURCE_HASH
+#define UHX_GENERATOR_SOURCE_HASH ""
+#endif
+
+static FString getSourceHash() {
+  return FString(ANSI_TO_TCHAR(UHX_GENERATOR_SOURCE_HASH));
+}
+
+namespace {
+
+class FFingerprint {
+private:
+  FSHA1 m_sha;
+
+public:
+  void addNumber(uint64 inValue) {
+    m_sha.Update(reinterpret_cast<const uint8 *>(&inValue), sizeof(inValue));
+  }
+
+  void addString(const FString& inValue) {
+    addNumber(inValue.Len());
+    m_sha.Update(reinterpret_cast<const uint8 *>(*inValue), inValue.Len() * sizeof(TCHAR));
+  }
+
+  void addName(const FName& inValue) {
+    addString(inValue.ToString());
+  }
+
+  void addHash(const FSHAHash& inValue) {
+    m_sha.Update(inValue.Hash, sizeof(inValue.Hash));
+  }
+
+  FSHAHash finish() {
+    FSHAHash ret;
+    m_sha.Final();
+    m_sha.GetHash(ret.Hash);
+    return ret;
+  }
+};
+
+}
+
+static void addHaxeType(FFingerprint& fp, const FHaxeTypeRef& inType) {
+  fp.addString(inType.toString());
+  fp.addString(inType.module);
+  fp.addString(inType.uname);
+  fp.addNumber(inType.haxeGenerated);
+  fp.addNumber((uint64) inType.kind);
+}
+
+static void addMetaData(FFingerprint& fp, UObject *inObj) {
+  auto map = UMetaData::GetMapForObject(inObj);
+  if (map == nullptr) {
+    fp.addNumber(0);
+    return;
+  }
+  fp.addNumber(map->Num());
+  for (auto& pair : *map) {
+    fp.addName(pair.Key);
+    fp.addString(pair.Value);
+  }
+}
+
+template<typename T>
+static void addDescriptor(FFingerprint& fp, const T *inDesc) {
+  if (inDesc == nullptr) {
+    fp.addNumber(0);
+  } else {
+    fp.addNumber(1);
+    fp.addString(inDesc->haxeType.toString());
+  }
+}
+
+static void addNonClass(FFingerprint& fp, const NonClassDescriptor *inDesc) {
+  addHaxeType(fp, inDesc->haxeType);
+  fp.addName(inDesc->module->getPackage()->GetFName());
+  auto headers = inDesc->getHeaders();
+  fp.addNumber(headers.Num());
+  for (auto& header : headers) {
+    fp.addString(header);
+  }
+}
+
+static void addProperty(FFingerprint& fp, const FHaxeTypes& inTypes, UProperty *inProp) {
+  fp.addName(inProp->GetClass()->GetFName());
+  fp.addName(inProp->GetFName());
+  fp.addString(inProp->GetNameCPP());
+  fp.addNumber(inProp->PropertyFlags);
+  fp.addNumber(inProp->ArrayDim);
+  fp.addNumber(inProp->HasAnyFlags(RF_Public));
+  addMetaData(fp, inProp);
+
+  // the Haxe names of all types this property references
+  if (auto structProp = Cast<UStructProperty>(inProp)) {
+    fp.addName(structProp->Struct->GetFName());
+    addDescriptor(fp, inTypes.getDescriptor(structProp->Struct));
+  } else if (auto classProp = Cast<UClassProperty>(inProp)) {
+    addDescriptor(fp, inTypes.getDescriptor(classProp->MetaClass));
+    addDescriptor(fp, inTypes.getDescriptor(classProp->PropertyClass));
+  } else if (auto objProp = Cast<UObjectPropertyBase>(inProp)) {
+    addDescriptor(fp, inTypes.getDescriptor(objProp->PropertyClass));
+  } else if (auto numeric = Cast<UNumericProperty>(inProp)) {
+    addDescriptor(fp, inTypes.getDescriptor(numeric->GetIntPropertyEnum()));
+  } else if (auto enumProp = Cast<UEnumProperty>(inProp)) {
+    addDescriptor(fp, inTypes.getDescriptor(enumProp->GetEnum()));
+  } else if (auto arrProp = Cast<UArrayProperty>(inProp)) {
+    addProperty(fp, inTypes, arrProp->Inner);
+  } else if (auto mapProp = Cast<UMapProperty>(inProp)) {
+    addProperty(fp, inTypes, mapProp->KeyProp);
+    addProperty(fp, inTypes, mapProp->ValueProp);
+  } else if (auto setProp = Cast<USetProperty>(inProp)) {
+    addProperty(fp, inTypes, setProp->ElementProp);
+  } else if (auto delProp = Cast<UDelegateProperty>(inProp)) {
+    addDescriptor(fp, inTypes.getDescriptor(delProp->SignatureFunction));
+  } else if (auto mcDelProp = Cast<UMulticastDelegateProperty>(inProp)) {
+    addDescriptor(fp, inTypes.getDescriptor(mcDelProp->SignatureFunction));
+  }
+}
+
+static void addFields(FFingerprint& fp, const FHaxeTypes& inTypes, UStruct *inStruct) {
+  for (TFieldIterator<UField> fields(inStruct, EFieldIteratorFlags::ExcludeSuper); fields; ++fields) {
+    auto field = *fields;
+    if (auto prop = Cast<UProperty>(field)) {
+      addProperty(fp, inTypes, prop);
+    } else if (auto func = Cast<UFunction>(field)) {
+      fp.addName(func->GetFName());
+      fp.addNumber(func->FunctionFlags);
+      addMetaData(fp, func);
+      for (TFieldIterator<UProperty> params(func); params; ++params) {
+        addProperty(fp, inTypes, *params);
+      }
+    } else {
+      fp.addName(field->GetFName());
+    }
+  }
+}
+
+FSHAHash FHaxeGenerationCache::getFieldNamesHash(UClass *inClass) const {
+  m_fieldNamesLock.ReadLock();
+  const FSHAHash *found = m_fieldNames.Find(inClass);
+  FSHAHash ret;
+  if (found != nullptr) {
+    ret = *found;
+  }
+  m_fieldNamesLock.ReadUnlock();
+  if (found != nullptr) {
+    return ret;
+  }
+
+  FFingerprint fp;
+  auto super = inClass->GetSuperClass();
+  fp.addNumber(super != nullptr);
+  if (super != nullptr) {
+    fp.addHash(getFieldNamesHash(super));
+  }
+  for (TFieldIterator<UField> fields(inClass, EFieldIteratorFlags::ExcludeSuper); fields; ++fields) {
+    fp.addName(fields->GetFName());
+  }
+  ret = fp.finish();
+
+  // another thread may have added it in the meantime, with the same hash
+  m_fieldNamesLock.WriteLock();
+  m_fieldNames.Add(inClass, ret);
+  m_fieldNamesLock.WriteUnlock();
+  return ret;
+}
+
+FSHAHash FHaxeGenerationCache::fingerprint(const FHaxeTypes& inTypes, const ClassDescriptor *inDesc) const {
+  FFingerprint fp;
+  auto uclass = inDesc->uclass;
+  addHaxeType(fp, inDesc->haxeType);
+  fp.addString(inDesc->header);
+  fp.addName(uclass->GetOuterUPackage()->GetFName());
+  fp.addName(uclass->GetFName());
+  fp.addNumber(uclass->ClassFlags);
+  addMetaData(fp, uclass);
+
+  // the first exported super class. All of its fields are considered as overridden by us
+  for (auto super = uclass->GetSuperClass(); super != nullptr; super = super->GetSuperClass()) {
+    auto superDesc = inTypes.getDescriptor(super);
+    if (superDesc != nullptr) {
+      fp.addString(superDesc->haxeType.toString());
+      fp.addHash(getFieldNamesHash(super));
+      break;
+    }
+  }
+
+  for (auto& impl : uclass->Interfaces) {
+    fp.addName(impl.Class->GetFName());
+    addDescriptor(fp, inTypes.getDescriptor(impl.Class));
+    addFields(fp, inTypes, impl.Class);
+  }
+  addFields(fp, inTypes, uclass);
+  return fp.finish();
+}
+
+FSHAHash FHaxeGenerationCache::fingerprint(const FHaxeTypes& inTypes, const StructDescriptor *inDesc) const {
+  FFingerprint fp;
+  auto ustruct = inDesc->ustruct;
+  addNonClass(fp, inDesc);
+  fp.addName(ustruct->GetFName());
+  fp.addNumber(ustruct->StructFlags);
+  addMetaData(fp, ustruct);
+  auto ops = ustruct->GetCppStructOps();
+  fp.addNumber(ops != nullptr);
+  if (ops != nullptr) {
+    fp.addNumber(ops->IsAbstract());
+    fp.addNumber(ops->HasIdentical());
+  }
+
+  for (auto super = ustruct->GetSuperStruct(); super != nullptr; super = super->GetSuperStruct()) {
+    auto superDesc = inTypes.getDescriptor((UScriptStruct *) super);
+    if (superDesc != nullptr) {
+      fp.addString(superDesc->haxeType.toString());
+      break;
+    }
+  }
+  addFields(fp, inTypes, ustruct);
+  return fp.finish();
+}
+
+FSHAHash FHaxeGenerationCache::fingerprint(const FHaxeTypes& inTypes, const EnumDescriptor *inDesc) const {
+  FFingerprint fp;
+  auto uenum = inDesc->uenum;
+  addNonClass(fp, inDesc);
+  fp.addString(uenum->CppType);
+  fp.addNumber((uint64) uenum->GetCppForm());
+  // this includes the entries' metadata as well
+  addMetaData(fp, uenum);
+  fp.addNumber(uenum->NumEnums());
+  for (int i = 0; i < uenum->NumEnums(); i++) {
+    fp.addString(uenum->GetNameStringByIndex(i));
+  }
+  return fp.finish();
+}
+
+FSHAHash FHaxeGenerationCache::fingerprint(const FHaxeTypes& inTypes, const DelegateDescriptor *inDesc) const {
+  FFingerprint fp;
+  auto udelegate = inDesc->delegateSignature;
+  addNonClass(fp, inDesc);
+  auto outer = udelegate->GetOuter();
+  if (!outer->IsA<UPackage>() && outer->IsA<UStruct>()) {
+    auto ustructOuter = Cast<UStruct>(outer);
+    fp.addString(ustructOuter->GetPrefixCPP());
+    fp.addName(ustructOuter->GetFName());
+  }
+  fp.addNumber(udelegate->FunctionFlags);
+  addMetaData(fp, udelegate);
+  for (TFieldIterator<UProperty> params(udelegate); params; ++params) {
+    addProperty(fp, inTypes, *params);
+  }
+  return fp.finish();
+}
+
+void FHaxeGenerationCache::load(const FString& inPath) {
+  m_path = inPath;
+  m_previous.Reset();
+  m_current.Reset();
+
+  TArray<uint8> data;
+  if (!FFileHelper::LoadFileToArray(data, *inPath, FILEREAD_Silent)) {
+    return;
+  }
+  FMemoryReader reader(data);
+  int32 version = 0;
+  FString sourceHash;
+  reader << version;
+  if (version != CacheVersion) {
+    return;
+  }
+  reader << sourceHash;
+  if (sourceHash != getSourceHash()) {
+    return;
+  }
+  reader << m_previous;
+  if (reader.IsError()) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Ignoring corrupt generation cache %s"), *inPath);
+    m_previous.Reset();
+  }
+}
+
+bool FHaxeGenerationCache::save() {
+  if (m_path.IsEmpty()) {
+    return true;
+  }
+  TArray<uint8> data;
+  FMemoryWriter writer(data);
+  int32 version = CacheVersion;
+  FString sourceHash = getSourceHash();
+  writer << version;
+  writer << sourceHash;
+  writer << m_current;
+  if (!FFileHelper::SaveArrayToFile(data, *m_path)) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Cannot write generation cache at path %s"), *m_path);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,184 @@
+#include "HaxeGeneratorConfig.h"
+#include "HaxeTypes.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Paths.h"
+
+static TArray<FString> getModulesFromEnv(const TCHAR *inVar) {
+  FString env = FPlatformMisc::GetEnvironmentVariable(inVar);
+  TArray<FString> ret;
+  env.ParseIntoArray(ret,TEXT(","),true);
+  return ret;
+}
+
+FHaxeGeneratorConfig::FPattern FHaxeGeneratorConfig::FPattern::compile(const FString& inGlob) {
+  FPattern ret;
+  int32 firstStar = INDEX_NONE;
+  int32 lastStar = INDEX_NONE;
+  inGlob.FindChar(TEXT('*'), firstStar);
+  inGlob.FindLastChar(TEXT('*'), lastStar);
+  bool hasQuestion = inGlob.Contains(TEXT("?"));
+  if (!hasQuestion && firstStar == lastStar && firstStar == inGlob.Len() - 1) {
+    ret.kind = EKind::Prefix;
+    ret.text = inGlob.LeftChop(1);
+  } else if (!hasQuestion && firstStar == lastStar && firstStar == 0) {
+    ret.kind = EKind::Suffix;
+    ret.text = inGlob.RightChop(1);
+  } else {
+    ret.kind = EKind::Wildcard;
+    ret.text = inGlob;
+  }
+  return ret;
+}
+
+bool FHaxeGeneratorConfig::FPattern::matches(const FString& inName) const {
+  switch (kind) {
+  case EKind::Prefix:
+    return inName.StartsWith(text);
+  case EKind::Suffix:
+    return inName.EndsWith(text);
+  default:
+    return inName.MatchesWildcard(text);
+  }
+}
+
+FHaxeGeneratorConfig::FHaxeGeneratorConfig() {
+  m_modules.Append(getModulesFromEnv(TEXT("EXTERN_MODULES")));
+  m_unrealModules.Append(getModulesFromEnv(TEXT("UNREAL_EXTERN_MODULES")));
+
+  // CppStuctOps doesn't work inside the header parser
+  // so we need to manually add non-copy fields here
+  static const TCHAR *noCopyStructs[] = {
+    TEXT("SkeletalMeshComponentEndPhysicsTickFunction"),
+    TEXT("SkeletalMeshComponentClothTickFunction"),
+    TEXT("StaticMeshComponentLODInfo"),
+    TEXT("KeyHandleMap"),
+    TEXT("RichCurveKey"),
+    TEXT("PointerToUberGraphFrame"),
+    TEXT("TickFunction"),
+    TEXT("ActorTickFunction"),
+    TEXT("ActorComponentTickFunction"),
+    TEXT("PrimitiveComponentPostPhysicsTickFunction"),
+    TEXT("StartPhysicsTickFunction"),
+    TEXT("EndPhysicsTickFunction"),
+    TEXT("StartAsyncSimulationFunction"),
+    TEXT("LevelCollection"),
+    TEXT("CharacterMovementComponentPostPhysicsTickFunction"),
+    TEXT("BodyInstance"),
+    TEXT("StartPhysics2DTickFunction"),
+    TEXT("EndPhysics2DTickFunction"),
+    TEXT("TestTickFunction"),
+    TEXT("CachedMovieSceneEvaluationTemplate"),
+    TEXT("MovieSceneEvaluationTrack"),
+  };
+  for (auto name : noCopyStructs) {
+    m_noCopyStructs.Add(FName(name));
+  }
+  // HACK: we need this since some types struggle with some operators (e.g. set operator)
+  //       we'll need to find a better way to deal with this, but for now we'll just not include that into the built
+  m_unsupportedElements.Add(FName(TEXT("StaticMeshComponentLODInfo")));
+}
+
+FHaxeGeneratorConfig& FHaxeGeneratorConfig::get() {
+  static FHaxeGeneratorConfig config;
+  return config;
+}
+
+void FHaxeGeneratorConfig::load(const FString& inPath) {
+  if (inPath.IsEmpty() || !FPaths::FileExists(inPath)) {
+    return;
+  }
+  FConfigFile file;
+  file.Read(inPath);
+  m_path = inPath;
+
+  auto getArray = [&file](const TCHAR *inSection, const TCHAR *inKey, TArray<FString>& outValues) {
+    const FConfigSection *section = file.Find(inSection);
+    if (section != nullptr) {
+      TArray<FConfigValue> values;
+      section->MultiFind(inKey, values, true);
+      for (auto& value : values) {
+        outValues.Add(value.GetValue());
+      }
+    }
+  };
+
+  TArray<FString> values;
+  getArray(TEXT("Modules"), TEXT("Include"), values);
+  for (auto& glob : values) {
+    if (glob.Contains(TEXT("*")) || glob.Contains(TEXT("?"))) {
+      m_include.Add(FPattern::compile(glob));
+    } else {
+      m_modules.Add(glob);
+    }
+  }
+  values.Reset();
+  getArray(TEXT("Modules"), TEXT("UnrealInclude"), values);
+  for (auto& glob : values) {
+    if (glob.Contains(TEXT("*")) || glob.Contains(TEXT("?"))) {
+      m_unrealInclude.Add(FPattern::compile(glob));
+    } else {
+      m_unrealModules.Add(glob);
+    }
+  }
+  values.Reset();
+  getArray(TEXT("Modules"), TEXT("Exclude"), values);
+  for (auto& glob : values) {
+    m_exclude.Add(FPattern::compile(glob));
+  }
+
+  values.Reset();
+  getArray(TEXT("Types"), TEXT("NoCopy"), values);
+  for (auto& name : values) {
+    m_noCopyStructs.Add(FName(*name));
+  }
+  values.Reset();
+  getArray(TEXT("Types"), TEXT("UnsupportedElement"), values);
+  for (auto& name : values) {
+    m_unsupportedElements.Add(FName(*name));
+  }
+
+  LOG("Loaded generator config from %s", *inPath);
+}
+
+bool FHaxeGeneratorConfig::matchesAny(const TArray<FPattern>& inPatterns, const FString& inName) {
+  for (auto& pattern : inPatterns) {
+    if (pattern.matches(inName)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint8 FHaxeGeneratorConfig::decide(const FString& inName) const {
+  uint8 ret = 0;
+  if (!matchesAny(m_exclude, inName)) {
+    if (m_unrealModules.Contains(inName) || matchesAny(m_unrealInclude, inName)) {
+      ret |= DUnreal;
+    }
+    bool isGame;
+    if (isCompilingGameCode()) {
+      isGame = m_modules.Contains(inName) || matchesAny(m_include, inName);
+    } else {
+      // when compiling the engine, every module is generated
+      isGame = true;
+    }
+    if (isGame && inName != TEXT("HaxeInit")) {
+      ret |= DGame;
+    }
+  }
+  return ret;
+}
+
+bool FHaxeGeneratorConfig::isSupportedElement(const UProperty *inProp) const {
+  const UField *type = nullptr;
+  if (auto structProp = Cast<UStructProperty>(inProp)) {
+    type = structProp->Struct;
+  } else if (auto enumProp = Cast<UEnumProperty>(inProp)) {
+    type = enumProp->GetEnum();
+  } else if (auto numericProp = Cast<UNumericProperty>(inProp)) {
+    type = numericProp->GetIntPropertyEnum();
+  } else if (auto objProp = Cast<UObjectPropertyBase>(inProp)) {
+    type = objProp->PropertyClass;
+  }
+  return type == nullptr || !m_unsupportedElements.Contains(type->GetFName());
+}
@@ -0,0 +1,184 @@
+#include "HaxeGeneratorStats.h"
+#include "HaxeTypes.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+
+FHaxeGeneratorStats::FPhase& FHaxeGeneratorStats::findPhase(const TCHAR *inName) {
+  for (auto& phase : m_phases) {
+    if (phase.name == inName) {
+      return phase;
+    }
+  }
+  FPhase phase;
+  phase.name = inName;
+  phase.seconds = 0;
+  phase.count = 0;
+  return m_phases[m_phases.Add(phase)];
+}
+
+void FHaxeGeneratorStats::addPhase(const TCHAR *inPhase, double inStart, double inEnd, int64 inCount, const FString& inEvent) {
+  auto& phase = findPhase(inPhase);
+  phase.seconds += inEnd - inStart;
+  phase.count += inCount;
+  if (m_trace) {
+    FTraceEvent ev;
+    ev.name = inEvent.IsEmpty() ? FString(inPhase) : inEvent;
+    ev.category = inPhase;
+    ev.start = inStart;
+    ev.seconds = inEnd - inStart;
+    ev.threadId = FPlatformTLS::GetCurrentThreadId();
+    m_events.Add(ev);
+  }
+}
+
+void FHaxeGeneratorStats::addWork(const TCHAR *inPhase, const FString& inEvent, double inStart, double inEnd, uint32 inThreadId) {
+  auto& phase = findPhase(inPhase);
+  phase.seconds += inEnd - inStart;
+  phase.count++;
+  if (m_trace) {
+    FTraceEvent ev;
+    ev.name = inEvent.IsEmpty() ? FString(inPhase) : inEvent;
+    ev.category = inPhase;
+    ev.start = inStart;
+    ev.seconds = inEnd - inStart;
+    ev.threadId = inThreadId;
+    m_events.Add(ev);
+  }
+}
+
+void FHaxeGeneratorStats::addType(const TCHAR *inKind, const FString& inName, double inStart, double inEnd, uint32 inThreadId, bool inCached) {
+  auto& phase = findPhase(*(FString(TEXT("generate ")) + inKind));
+  phase.seconds += inEnd - inStart;
+  phase.count++;
+
+  FTypeTime type;
+  type.name = inName;
+  type.kind = inKind;
+  type.seconds = inEnd - inStart;
+  type.cached = inCached;
+  m_types.Add(type);
+
+  if (m_trace) {
+    FTraceEvent ev;
+    ev.name = inName;
+    ev.category = inKind;
+    ev.start = inStart;
+    ev.seconds = inEnd - inStart;
+    ev.threadId = inThreadId;
+    m_events.Add(ev);
+  }
+}
+
+void FHaxeGeneratorStats::addFile(const FString& inModule, int64 inBytes, bool inWritten) {
+  auto& module = m_modules.FindOrAdd(inModule);
+  module.files++;
+  module.bytes += inBytes;
+  if (inWritten) {
+    module.filesWritten++;
+    module.bytesWritten += inBytes;
+  }
+}
+
+bool FHaxeGeneratorStats::save(const FString& inReportPath, const FString& inTracePath, int32 inSlowest) const {
+  FString report;
+  {
+    auto writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&report);
+    writer->WriteObjectStart();
+    writer->WriteValue(TEXT("totalSeconds"), FPlatformTime::Seconds() - m_start);
+
+    writer->WriteArrayStart(TEXT("phases"));
+    for (const auto& phase : m_phases) {
+      writer->WriteObjectStart();
+      writer->WriteValue(TEXT("name"), phase.name);
+      writer->WriteValue(TEXT("seconds"), phase.seconds);
+      writer->WriteValue(TEXT("count"), phase.count);
+      writer->WriteObjectEnd();
+    }
+    writer->WriteArrayEnd();
+
+    TArray<FString> moduleNames;
+    m_modules.GetKeys(moduleNames);
+    moduleNames.Sort();
+    FModuleOutput total;
+    writer->WriteArrayStart(TEXT("modules"));
+    for (const auto& name : moduleNames) {
+      const auto& module = m_modules[name];
+      writer->WriteObjectStart();
+      writer->WriteValue(TEXT("name"), name);
+      writer->WriteValue(TEXT("files"), module.files);
+      writer->WriteValue(TEXT("filesWritten"), module.filesWritten);
+      writer->WriteValue(TEXT("bytes"), module.bytes);
+      writer->WriteValue(TEXT("bytesWritten"), module.bytesWritten);
+      writer->WriteObjectEnd();
+      total.files += module.files;
+      total.filesWritten += module.filesWritten;
+      total.bytes += module.bytes;
+      total.bytesWritten += module.bytesWritten;
+    }
+    writer->WriteArrayEnd();
+
+    writer->WriteObjectStart(TEXT("total"));
+    writer->WriteValue(TEXT("files"), total.files);
+    writer->WriteValue(TEXT("filesWritten"), total.filesWritten);
+    writer->WriteValue(TEXT("bytes"), total.bytes);
+    writer->WriteValue(TEXT("bytesWritten"), total.bytesWritten);
+    writer->WriteObjectEnd();
+
+    TArray<const FTypeTime *> slowest;
+    slowest.Reserve(m_types.Num());
+    for (const auto& type : m_types) {
+      slowest.Add(&type);
+    }
+    slowest.Sort([](const FTypeTime& a, const FTypeTime& b) { return a.seconds > b.seconds; });
+    writer->WriteArrayStart(TEXT("slowestTypes"));
+    for (int32 i = 0; i < slowest.Num() && i < inSlowest; i++) {
+      writer->WriteObjectStart();
+      writer->WriteValue(TEXT("name"), slowest[i]->name);
+      writer->WriteValue(TEXT("kind"), FString(slowest[i]->kind));
+      writer->WriteValue(TEXT("seconds"), slowest[i]->seconds);
+      writer->WriteValue(TEXT("cached"), slowest[i]->cached);
+      writer->WriteObjectEnd();
+    }
+    writer->WriteArrayEnd();
+
+    writer->WriteObjectEnd();
+    writer->Close();
+  }
+  if (!FFileHelper::SaveStringToFile(report, *inReportPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM)) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Cannot write stats report at path %s"), *inReportPath);
+    return false;
+  }
+
+  if (!m_trace) {
+    return true;
+  }
+  // this is the trace event format understood by chrome://tracing: one complete ("X") event per recorded time
+  FString trace;
+  {
+    auto writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&trace);
+    writer->WriteObjectStart();
+    writer->WriteArrayStart(TEXT("traceEvents"));
+    for (const auto& ev : m_events) {
+      writer->WriteObjectStart();
+      writer->WriteValue(TEXT("name"), ev.name);
+      writer->WriteValue(TEXT("cat"), FString(ev.category));
+      writer->WriteValue(TEXT("ph"), FString(TEXT("X")));
+      writer->WriteValue(TEXT("ts"), (ev.start - m_start) * 1000000.0);
+      writer->WriteValue(TEXT("dur"), ev.seconds * 1000000.0);
+      writer->WriteValue(TEXT("pid"), 1);
+      writer->WriteValue(TEXT("tid"), (int64) ev.threadId);
+      writer->WriteObjectEnd();
+    }
+    writer->WriteArrayEnd();
+    writer->WriteObjectEnd();
+    writer->Close();
+  }
+  if (!FFileHelper::SaveStringToFile(trace, *inTracePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM)) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Cannot write trace at path %s"), *inTracePath);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,105 @@
+#include "HaxeOutputManifest.h"
+#include "HaxeTypes.h"
+#include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+// increment the version whenever the format changes
+static const TCHAR *ManifestHeader = TEXT("UHXMANIFEST 2");
+static const TCHAR *ManifestMagic = TEXT("UHXMANIFEST ");
+static const TCHAR *ManifestFooter = TEXT("END ");
+
+void FHaxeOutputManifest::load(const FString& inPath, const FString& inOutRoot) {
+  m_path = inPath;
+  m_entries.Reset();
+  m_dirty = false;
+  m_loaded = false;
+
+  FString contents;
+  if (!FFileHelper::LoadFileToString(contents, *inPath)) {
+    return;
+  }
+
+  TArray<FString> lines;
+  contents.ParseIntoArrayLines(lines, true);
+  if (lines.Num() > 0 && lines[0] != ManifestHeader && lines[0].StartsWith(ManifestMagic)) {
+    LOG("Ignoring manifest file %s from another version of the generator", *inPath);
+    return;
+  }
+  if (lines.Num() < 2 || lines[0] != ManifestHeader || !lines.Last().StartsWith(ManifestFooter)) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Ignoring corrupt manifest file %s"), *inPath);
+    return;
+  }
+
+  for (int32 i = 1; i < lines.Num() - 1; i++) {
+    const FString& line = lines[i];
+    FString hash, rest, file, types;
+    if (!line.Split(TEXT("\t"), &hash, &rest, ESearchCase::CaseSensitive, ESearchDir::FromStart) || hash.Len() != 40 ||
+        !rest.Split(TEXT("\t"), &file, &types, ESearchCase::CaseSensitive, ESearchDir::FromStart) || file.IsEmpty()) {
+      UE_LOG(LogHaxeExtern, Warning, TEXT("Ignoring corrupt manifest file %s"), *inPath);
+      m_entries.Reset();
+      return;
+    }
+    FEntry entry;
+    entry.hash.FromString(hash);
+    types.ParseIntoArray(entry.types, TEXT(";"), true);
+    m_entries.Add(file, MoveTemp(entry));
+  }
+
+  int32 count = FCString::Atoi(*lines.Last().RightChop(FCString::Strlen(ManifestFooter)));
+  if (count != m_entries.Num()) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Ignoring corrupt manifest file %s"), *inPath);
+    m_entries.Reset();
+    return;
+  }
+  m_loaded = true;
+
+  if (!IFileManager::Get().DirectoryExists(*inOutRoot)) {
+    // the files of this output directory were deleted (e.g. by hand), so they must all be written again. The manifest
+    // is shared by the engine and game runs, so the files of the other output directory are kept
+    FString root = inOutRoot;
+    FPaths::MakeStandardFilename(root);
+    TArray<FString> files;
+    getFilesUnder(root, files);
+    for (auto& file : files) {
+      remove(file);
+    }
+  }
+}
+
+void FHaxeOutputManifest::getFilesUnder(const FString& inRoot, TArray<FString>& outFiles) const {
+  FString prefix = inRoot;
+  if (!prefix.EndsWith(TEXT("/"))) {
+    prefix += TEXT("/");
+  }
+  for (auto& entry : m_entries) {
+    if (entry.Key.StartsWith(prefix, ESearchCase::CaseSensitive)) {
+      outFiles.Add(entry.Key);
+    }
+  }
+}
+
+void FHaxeOutputManifest::getAllTypes(TMap<FString, TArray<FString>>& outTypes) const {
+  for (auto& entry : m_entries) {
+    outTypes.Add(entry.Key, entry.Value.types);
+  }
+}
+
+bool FHaxeOutputManifest::save() {
+  if (!m_dirty || m_path.IsEmpty()) {
+    return true;
+  }
+
+  FString contents = ManifestHeader;
+  contents += TEXT("\n");
+  for (auto& entry : m_entries) {
+    contents += entry.Value.hash.ToString() + TEXT("\t") + entry.Key + TEXT("\t") + FString::Join(entry.Value.types, TEXT(";")) + TEXT("\n");
+  }
+  contents += FString::Printf(TEXT("%s%d\n"), ManifestFooter, m_entries.Num());
+  if (!FFileHelper::SaveStringToFile(contents, *m_path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM)) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Cannot write manifest file at path %s"), *m_path);
+    return false;
+  }
+  m_dirty = false;
+  return true;
+}
@@ -0,0 +1,173 @@
+#include "HaxeReflectionSnapshot.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
+
+static void getMetaData(UObject *inObj, TArray<FString>& outKeys, TArray<FString>& outValues) {
+  auto map = UMetaData::GetMapForObject(inObj);
+  if (map == nullptr) {
+    return;
+  }
+  for (auto& pair : *map) {
+    outKeys.Add(pair.Key.ToString());
+    outValues.Add(pair.Value);
+  }
+}
+
+void FHaxeReflectionSnapshot::record(UClass *inClass, const FString& inHeader, const FString& inModule) {
+  FHaxeSnapshotExport exp;
+  exp.classPath = inClass->GetPathName();
+  exp.header = inHeader;
+  exp.module = inModule;
+  m_exports.Add(exp);
+  m_exportClasses.Add(inClass);
+}
+
+FString FHaxeReflectionSnapshot::addReference(UObject *inType) {
+  if (inType == nullptr) {
+    return FString();
+  }
+  addType(inType);
+  return inType->GetPathName();
+}
+
+void FHaxeReflectionSnapshot::addProperty(UProperty *inProp, FHaxeSnapshotProperty& outProp) {
+  outProp.name = inProp->GetName();
+  outProp.propClass = inProp->GetClass()->GetPathName();
+  outProp.flags = (uint64) inProp->PropertyFlags;
+  outProp.arrayDim = inProp->ArrayDim;
+  outProp.isPublic = inProp->HasAnyFlags(RF_Public);
+  getMetaData(inProp, outProp.metaKeys, outProp.metaValues);
+
+  if (auto boolProp = Cast<UBoolProperty>(inProp)) {
+    outProp.isNativeBool = boolProp->IsNativeBool();
+  } else if (auto structProp = Cast<UStructProperty>(inProp)) {
+    outProp.type = addReference(structProp->Struct);
+  } else if (auto classProp = Cast<UClassProperty>(inProp)) {
+    outProp.type = addReference(classProp->MetaClass);
+  } else if (auto objProp = Cast<UObjectPropertyBase>(inProp)) {
+    outProp.type = addReference(objProp->PropertyClass);
+  } else if (auto interfaceProp = Cast<UInterfaceProperty>(inProp)) {
+    outProp.type = addReference(interfaceProp->InterfaceClass);
+  } else if (auto byteProp = Cast<UByteProperty>(inProp)) {
+    outProp.type = addReference(byteProp->Enum);
+  } else if (auto enumProp = Cast<UEnumProperty>(inProp)) {
+    outProp.type = addReference(enumProp->GetEnum());
+    addProperty(enumProp->GetUnderlyingProperty(), outProp.inner[outProp.inner.AddDefaulted()]);
+  } else if (auto delProp = Cast<UDelegateProperty>(inProp)) {
+    outProp.type = addReference(delProp->SignatureFunction);
+  } else if (auto mcDelProp = Cast<UMulticastDelegateProperty>(inProp)) {
+    outProp.type = addReference(mcDelProp->SignatureFunction);
+  } else if (auto arrProp = Cast<UArrayProperty>(inProp)) {
+    addProperty(arrProp->Inner, outProp.inner[outProp.inner.AddDefaulted()]);
+  } else if (auto mapProp = Cast<UMapProperty>(inProp)) {
+    outProp.inner.AddDefaulted(2);
+    addProperty(mapProp->KeyProp, outProp.inner[0]);
+    addProperty(mapProp->ValueProp, outProp.inner[1]);
+  } else if (auto setProp = Cast<USetProperty>(inProp)) {
+    addProperty(setProp->ElementProp, outProp.inner[outProp.inner.AddDefaulted()]);
+  }
+}
+
+void FHaxeReflectionSnapshot::addType(UObject *inType) {
+  if (m_typeIds.Contains(inType)) {
+    return;
+  }
+  if (!inType->IsA<UStruct>() && !inType->IsA<UEnum>()) {
+    return;
+  }
+  UObject *outer = inType->GetOuter();
+  if (!outer->IsA<UPackage>()) {
+    // the class must be created before its functions and delegates
+    addType(outer);
+    if (m_typeIds.Contains(inType)) {
+      return;
+    }
+  }
+
+  // the record is built on its own, since adding the types it references adds more records
+  int32 id = m_types.AddDefaulted();
+  m_typeIds.Add(inType, id);
+  FHaxeSnapshotType type;
+  type.outer = outer->GetPathName();
+  type.name = inType->GetName();
+  getMetaData(inType, type.metaKeys, type.metaValues);
+
+  if (UClass *uclass = Cast<UClass>(inType)) {
+    type.kind = EHaxeSnapshotKind::Class;
+    type.flags = (uint32) uclass->ClassFlags;
+    type.super = addReference(uclass->GetSuperClass());
+    for (auto& impl : uclass->Interfaces) {
+      type.interfaces.Add(addReference(impl.Class));
+    }
+    for (TFieldIterator<UField> it(uclass, EFieldIteratorFlags::ExcludeSuper); it; ++it) {
+      type.children.Add(it->GetName());
+      if (UProperty *prop = Cast<UProperty>(*it)) {
+        addProperty(prop, type.props[type.props.AddDefaulted()]);
+      } else if (it->IsA<UFunction>()) {
+        addType(*it);
+      }
+    }
+  } else if (UFunction *func = Cast<UFunction>(inType)) {
+    type.kind = (func->FunctionFlags & FUNC_Delegate) != 0 ? EHaxeSnapshotKind::Delegate : EHaxeSnapshotKind::Function;
+    type.flags = (uint32) func->FunctionFlags;
+    for (TFieldIterator<UProperty> it(func); it; ++it) {
+      addProperty(*it, type.props[type.props.AddDefaulted()]);
+    }
+  } else if (UScriptStruct *ustruct = Cast<UScriptStruct>(inType)) {
+    type.kind = EHaxeSnapshotKind::Struct;
+    type.flags = (uint32) ustruct->StructFlags;
+    type.super = addReference(ustruct->GetSuperStruct());
+    for (TFieldIterator<UProperty> it(ustruct, EFieldIteratorFlags::ExcludeSuper); it; ++it) {
+      addProperty(*it, type.props[type.props.AddDefaulted()]);
+    }
+  } else if (UEnum *uenum = Cast<UEnum>(inType)) {
+    type.kind = EHaxeSnapshotKind::Enum;
+    type.cppForm = (uint8) uenum->GetCppForm();
+    type.cppType = uenum->CppType;
+    for (int32 i = 0; i < uenum->NumEnums(); i++) {
+      type.enumNames.Add(uenum->GetNameByIndex(i).ToString());
+      type.enumValues.Add(uenum->GetValueByIndex(i));
+    }
+  }
+  m_types[id] = MoveTemp(type);
+}
+
+bool FHaxeReflectionSnapshot::save(const FHaxeTypes& inTypes, const FString& inPath) {
+  m_types.Reset();
+  m_typeIds.Reset();
+  for (UClass *cls : m_exportClasses) {
+    addType(cls);
+  }
+  for (int32 id = 0; id < inTypes.getNumTypes(); id++) {
+    const auto& entry = inTypes.getType(id);
+    switch (entry.kind) {
+    case ETypeKind::KUStruct:
+      addType(entry.ustruct->ustruct);
+      break;
+    case ETypeKind::KUEnum:
+      addType(entry.uenum->uenum);
+      break;
+    case ETypeKind::KUDelegate:
+      addType(entry.udelegate->delegateSignature);
+      break;
+    default:
+      addType(entry.cls->uclass);
+      break;
+    }
+  }
+
+  TArray<uint8> data;
+  FMemoryWriter writer(data);
+  uint32 magic = HAXE_SNAPSHOT_MAGIC;
+  int32 version = HAXE_SNAPSHOT_VERSION;
+  writer << magic;
+  writer << version;
+  writer << m_types;
+  writer << m_exports;
+  if (!FFileHelper::SaveArrayToFile(data, *inPath)) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Cannot write reflection snapshot at path %s"), *inPath);
+    return false;
+  }
+  LOG("Saved %d types and %d exported classes to the reflection snapshot %s", m_types.Num(), m_exports.Num(), *inPath);
+  return true;
+}
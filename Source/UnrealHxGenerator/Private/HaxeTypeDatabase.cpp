@@ -0,0 +1,251 @@
+#include "HaxeTypeDatabase.h"
+#include "HaxeGenerator.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+
+using namespace HaxeGenerator;
+
+uint32 FHaxeTypeDatabase::hash(const FString& inQualifiedName) {
+  FTCHARToUTF8 utf8(*inQualifiedName);
+  uint32 ret = 2166136261u;
+  for (int32 i = 0; i < utf8.Length(); i++) {
+    ret ^= (uint8) utf8.Get()[i];
+    ret *= 16777619u;
+  }
+  return ret;
+}
+
+uint32 FHaxeTypeDatabase::addString(const FString& inStr) {
+  uint32 *found = m_stringIds.Find(inStr);
+  if (found != nullptr) {
+    return *found;
+  }
+  uint32 id = m_stringOffsets.Num();
+  m_stringOffsets.Add(m_stringData.Num());
+  FTCHARToUTF8 utf8(*inStr);
+  m_stringData.Append(reinterpret_cast<const uint8 *>(utf8.Get()), utf8.Length());
+  m_stringData.Add(0);
+  m_stringIds.Add(inStr, id);
+  return id;
+}
+
+void FHaxeTypeDatabase::addProperty(FHaxeGenerator& inGen, UProperty *inProp, EHaxeTypeDbFieldKind inKind) {
+  FString type;
+  bool supported = inGen.resolvePropertyType(inProp, type);
+
+  FHaxeTypeDbField field;
+  FMemory::Memzero(field);
+  field.name = addString(inProp->GetName());
+  field.haxeType = supported ? addString(type) : 0;
+  field.kind = inKind;
+  field.ueFlags = (uint64) inProp->PropertyFlags;
+  m_fields.Add(field);
+}
+
+void FHaxeTypeDatabase::addFields(FHaxeGenerator& inGen, const FHaxeTypeEntry& inEntry) {
+  switch (inEntry.kind) {
+  case ETypeKind::KUEnum: {
+    UEnum *uenum = inEntry.uenum->uenum;
+    for (int32 i = 0; i < uenum->NumEnums(); i++) {
+      FHaxeTypeDbField field;
+      FMemory::Memzero(field);
+      field.name = addString(uenum->GetNameStringByIndex(i));
+      field.kind = EHaxeTypeDbFieldKind::EnumEntry;
+      field.ueFlags = (uint64) uenum->GetValueByIndex(i);
+      m_fields.Add(field);
+    }
+    break;
+  }
+  case ETypeKind::KUStruct:
+    for (TFieldIterator<UProperty> it(inEntry.ustruct->ustruct, EFieldIteratorFlags::ExcludeSuper); it; ++it) {
+      addProperty(inGen, *it, EHaxeTypeDbFieldKind::Property);
+    }
+    break;
+  case ETypeKind::KUDelegate:
+    for (TFieldIterator<UProperty> it(inEntry.udelegate->delegateSignature); it; ++it) {
+      addProperty(inGen, *it, it->HasAnyPropertyFlags(CPF_ReturnParm) ? EHaxeTypeDbFieldKind::ReturnValue : EHaxeTypeDbFieldKind::Param);
+    }
+    break;
+  default: {
+    UClass *uclass = inEntry.cls->uclass;
+    for (TFieldIterator<UProperty> it(uclass, EFieldIteratorFlags::ExcludeSuper); it; ++it) {
+      addProperty(inGen, *it, EHaxeTypeDbFieldKind::Property);
+    }
+    for (TFieldIterator<UFunction> it(uclass, EFieldIteratorFlags::ExcludeSuper); it; ++it) {
+      UFunction *func = *it;
+      int32 funcIndex = m_fields.Num();
+      FHaxeTypeDbField field;
+      FMemory::Memzero(field);
+      field.name = addString(func->GetName());
+      field.kind = EHaxeTypeDbFieldKind::Function;
+      field.ueFlags = (uint64) func->FunctionFlags;
+      m_fields.Add(field);
+      for (TFieldIterator<UProperty> params(func); params; ++params) {
+        addProperty(inGen, *params, params->HasAnyPropertyFlags(CPF_ReturnParm) ? EHaxeTypeDbFieldKind::ReturnValue : EHaxeTypeDbFieldKind::Param);
+      }
+      m_fields[funcIndex].paramCount = m_fields.Num() - funcIndex - 1;
+    }
+    break;
+  }
+  }
+}
+
+void FHaxeTypeDatabase::build(const FHaxeTypes& inTypes, FHaxeGenerator& inGen) {
+  m_modules.Reset();
+  m_types.Reset();
+  m_fields.Reset();
+  m_stringIds.Reset();
+  m_stringOffsets.Reset();
+  m_stringData.Reset();
+  addString(FString());
+
+  // sort the types by module and name, so the same model always results in the same file
+  TArray<int32> ids;
+  for (int32 id = 0; id < inTypes.getNumTypes(); id++) {
+    ids.Add(id);
+  }
+  ids.Sort([&inTypes](int32 a, int32 b) {
+    const auto& entryA = inTypes.getType(a);
+    const auto& entryB = inTypes.getType(b);
+    UPackage *packA = entryA.getPackage();
+    UPackage *packB = entryB.getPackage();
+    if (packA != packB) {
+      return packA->GetName() < packB->GetName();
+    }
+    return entryA.getHaxeType().toString() < entryB.getHaxeType().toString();
+  });
+
+  TArray<uint32> dbIndices;
+  dbIndices.SetNumUninitialized(inTypes.getNumTypes());
+  for (int32 i = 0; i < ids.Num(); i++) {
+    dbIndices[ids[i]] = i;
+  }
+
+  TArray<uint32> hashes;
+  hashes.Reserve(ids.Num());
+  UPackage *lastPackage = nullptr;
+  for (int32 id : ids) {
+    const auto& entry = inTypes.getType(id);
+    const auto& haxeType = entry.getHaxeType();
+    UPackage *package = entry.getPackage();
+    if (package != lastPackage) {
+      FHaxeTypeDbModule module;
+      module.name = addString(FPackageName::GetShortName(package));
+      module.package = addString(package->GetName());
+      module.firstType = m_types.Num();
+      module.typeCount = 0;
+      m_modules.Add(module);
+      lastPackage = package;
+    }
+    m_modules.Last().typeCount++;
+
+    FHaxeTypeDbType type;
+    FMemory::Memzero(type);
+    type.qualifiedName = addString(haxeType.toString());
+    hashes.Add(hash(haxeType.toString()));
+    type.typePath = addString(haxeType.getTypePath());
+    type.name = addString(haxeType.getName());
+    type.haxeModule = addString(haxeType.getHaxeModule());
+    type.uname = addString(haxeType.uname);
+    type.module = m_modules.Num() - 1;
+    type.superType = HAXE_TYPEDB_NONE;
+    type.kind = (uint8) entry.kind;
+    type.flags = EHaxeTypeDbFlags::None;
+    if (entry.exported) {
+      type.flags |= EHaxeTypeDbFlags::Exported;
+    }
+    if (haxeType.haxeGenerated) {
+      type.flags |= EHaxeTypeDbFlags::HaxeGenerated;
+    }
+
+    switch (entry.kind) {
+    case ETypeKind::KUEnum:
+      type.headers = addString(FString::Join(entry.uenum->getHeaders(), TEXT(";")));
+      break;
+    case ETypeKind::KUStruct: {
+      type.headers = addString(FString::Join(entry.ustruct->getHeaders(), TEXT(";")));
+      type.ueFlags = (uint32) entry.ustruct->ustruct->StructFlags;
+      auto super = inTypes.getDescriptor(Cast<UScriptStruct>(entry.ustruct->ustruct->GetSuperStruct()));
+      if (super != nullptr) {
+        type.superType = dbIndices[super->id];
+      }
+      break;
+    }
+    case ETypeKind::KUDelegate:
+      type.headers = addString(FString::Join(entry.udelegate->getHeaders(), TEXT(";")));
+      type.ueFlags = (uint32) entry.udelegate->delegateSignature->FunctionFlags;
+      break;
+    default: {
+      type.headers = addString(entry.cls->header);
+      type.ueFlags = (uint32) entry.cls->uclass->ClassFlags;
+      auto super = inTypes.getDescriptor(entry.cls->uclass->GetSuperClass());
+      if (super != nullptr) {
+        type.superType = dbIndices[super->id];
+      }
+      break;
+    }
+    }
+
+    type.firstField = m_fields.Num();
+    // only the fields of the types that were generated are resolved; other types are only there to be referenced
+    if (entry.exported && entry.shouldGenerate(true)) {
+      addFields(inGen, entry);
+    }
+    type.fieldCount = m_fields.Num() - type.firstField;
+    m_types.Add(type);
+  }
+
+  buildIndex(hashes);
+}
+
+void FHaxeTypeDatabase::buildIndex(const TArray<uint32>& inHashes) {
+  uint32 size = FMath::RoundUpToPowerOfTwo(FMath::Max(m_types.Num() * 2, 2));
+  m_index.Reset();
+  m_index.AddZeroed(size);
+  for (int32 i = 0; i < m_types.Num(); i++) {
+    uint32 bucket = inHashes[i] & (size - 1);
+    while (m_index[bucket] != 0) {
+      bucket = (bucket + 1) & (size - 1);
+    }
+    m_index[bucket] = i + 1;
+  }
+}
+
+bool FHaxeTypeDatabase::save(const FString& inPath) const {
+  FHaxeTypeDbHeader header;
+  header.magic = HAXE_TYPEDB_MAGIC;
+  header.version = HAXE_TYPEDB_VERSION;
+  header.moduleCount = m_modules.Num();
+  header.modulesOffset = sizeof(FHaxeTypeDbHeader);
+  header.typeCount = m_types.Num();
+  header.typesOffset = header.modulesOffset + m_modules.Num() * sizeof(FHaxeTypeDbModule);
+  header.fieldCount = m_fields.Num();
+  header.fieldsOffset = header.typesOffset + m_types.Num() * sizeof(FHaxeTypeDbType);
+  header.indexSize = m_index.Num();
+  header.indexOffset = header.fieldsOffset + m_fields.Num() * sizeof(FHaxeTypeDbField);
+  header.stringCount = m_stringOffsets.Num();
+  header.stringsOffset = header.indexOffset + m_index.Num() * sizeof(uint32);
+  header.stringDataOffset = header.stringsOffset + m_stringOffsets.Num() * sizeof(uint32);
+  header.stringDataSize = m_stringData.Num();
+
+  TArray<uint8> data;
+  data.Reserve(header.stringDataOffset + header.stringDataSize);
+  // every platform the generator runs on is little-endian, so the records are written as they are in memory
+  data.Append(reinterpret_cast<const uint8 *>(&header), sizeof(header));
+  data.Append(reinterpret_cast<const uint8 *>(m_modules.GetData()), m_modules.Num() * sizeof(FHaxeTypeDbModule));
+  data.Append(reinterpret_cast<const uint8 *>(m_types.GetData()), m_types.Num() * sizeof(FHaxeTypeDbType));
+  data.Append(reinterpret_cast<const uint8 *>(m_fields.GetData()), m_fields.Num() * sizeof(FHaxeTypeDbField));
+  data.Append(reinterpret_cast<const uint8 *>(m_index.GetData()), m_index.Num() * sizeof(uint32));
+  data.Append(reinterpret_cast<const uint8 *>(m_stringOffsets.GetData()), m_stringOffsets.Num() * sizeof(uint32));
+  data.Append(m_stringData);
+
+  TArray<uint8> previous;
+  if (FFileHelper::LoadFileToArray(previous, *inPath, FILEREAD_Silent) && previous == data) {
+    return true;
+  }
+  if (!FFileHelper::SaveArrayToFile(data, *inPath)) {
+    UE_LOG(LogHaxeExtern, Warning, TEXT("Cannot write type database at path %s"), *inPath);
+    return false;
+  }
+  return true;
+}
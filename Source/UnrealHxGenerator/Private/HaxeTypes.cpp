@@ -1,5 +1,199 @@
 #include "HaxeTypes.h"
 #include "IHaxeExternGenerator.h"
 #include "HaxeGenerator.h"
+#include "Runtime/Launch/Resources/Version.h"
 
 const FHaxeTypeRef FHaxeTypes::nulltype = FHaxeTypeRef("", ETypeKind::KNone);
+
+const FString *FHaxeMetaKeys::findComposite(const TMap<FName, FString> *inMap, const TCHAR *inPrefix, const FString& inName, const TCHAR *inSuffix) {
+  if (inMap == nullptr || inMap->Num() == 0) {
+    return nullptr;
+  }
+  int32 prefixLen = FCString::Strlen(inPrefix);
+  int32 suffixLen = FCString::Strlen(inSuffix);
+  TCHAR key[NAME_SIZE];
+  if (prefixLen + inName.Len() + suffixLen >= NAME_SIZE) {
+    return nullptr;
+  }
+  FMemory::Memcpy(key, inPrefix, prefixLen * sizeof(TCHAR));
+  FMemory::Memcpy(key + prefixLen, *inName, inName.Len() * sizeof(TCHAR));
+  FMemory::Memcpy(key + prefixLen + inName.Len(), inSuffix, (suffixLen + 1) * sizeof(TCHAR));
+  // if the name doesn't exist yet, no metadata can have it as its key
+  FName name(key, FNAME_Find);
+  if (name.IsNone()) {
+    return nullptr;
+  }
+  return inMap->Find(name);
+}
+
+const FHaxePackage& FHaxePackage::intern(const TArray<FString>& inPack) {
+  static FCriticalSection lock;
+  static TMap<FString, TUniquePtr<FHaxePackage>> pool;
+  FString key = FString::Join(inPack, TEXT("."));
+  FScopeLock scopeLock(&lock);
+  auto found = pool.Find(key);
+  if (found != nullptr) {
+    return **found;
+  }
+  return *pool.Add(key, MakeUnique<FHaxePackage>(inPack));
+}
+
+const FHaxePackageInfo& HaxeTypeHelpers::getPackageInfo(UPackage *inPack) {
+  static FCriticalSection lock;
+  static TMap<UPackage *, TUniquePtr<FHaxePackageInfo>> cache;
+  FScopeLock scopeLock(&lock);
+  auto found = cache.Find(inPack);
+  if (found != nullptr) {
+    return **found;
+  }
+  auto info = MakeUnique<FHaxePackageInfo>();
+  info->haxePackage = &FHaxePackage::intern(resolveHaxePackage(inPack, info->module));
+  info->generate = shouldGenerateModule(info->module);
+  info->generateWithUnreal = shouldGenerateModule(info->module, true);
+  return *cache.Add(inPack, MoveTemp(info));
+}
+
+const FString& FHaxeNamePool::intern(const FString& inStr) {
+  static FCriticalSection lock;
+  static TMap<FString, TUniquePtr<FString>> pool;
+  FScopeLock scopeLock(&lock);
+  auto found = pool.Find(inStr);
+  if (found != nullptr) {
+    return **found;
+  }
+  return *pool.Add(inStr, MakeUnique<FString>(inStr));
+}
+
+#if ENGINE_MINOR_VERSION < 18
+// soft class properties were called asset class properties before 4.18
+typedef UAssetClassProperty USoftClassProperty;
+#endif
+
+/**
+ * Adds the classes referenced by an object, class or interface property, or by the elements of a container
+ **/
+template<typename Allocator>
+static void collectClassRefs(UProperty *inProp, TArray<UClass *, Allocator>& outClasses) {
+  if (auto arrayProp = Cast<UArrayProperty>(inProp)) {
+    collectClassRefs(arrayProp->Inner, outClasses);
+  } else if (auto mapProp = Cast<UMapProperty>(inProp)) {
+    collectClassRefs(mapProp->KeyProp, outClasses);
+    collectClassRefs(mapProp->ValueProp, outClasses);
+  } else if (auto setProp = Cast<USetProperty>(inProp)) {
+    collectClassRefs(setProp->ElementProp, outClasses);
+  } else if (auto classProp = Cast<UClassProperty>(inProp)) {
+    outClasses.Add(classProp->MetaClass);
+  } else if (auto softClassProp = Cast<USoftClassProperty>(inProp)) {
+    outClasses.Add(softClassProp->MetaClass);
+  } else if (auto objProp = Cast<UObjectPropertyBase>(inProp)) {
+    outClasses.Add(objProp->PropertyClass);
+  } else if (auto interfaceProp = Cast<UInterfaceProperty>(inProp)) {
+    outClasses.Add(interfaceProp->InterfaceClass);
+  }
+}
+
+void FHaxeTypes::getDependencies(const FHaxeTypeEntry& inEntry, TArray<int32>& outIds) {
+  TArray<FHaxeTouchEdge, TInlineAllocator<16>> edges;
+  TArray<UClass *, TInlineAllocator<16>> classes;
+  switch (inEntry.kind) {
+  case ETypeKind::KUEnum:
+    break;
+  case ETypeKind::KUStruct:
+    edges.Append(getBodyEdges(inEntry.ustruct->ustruct));
+    for (TFieldIterator<UProperty> props(inEntry.ustruct->ustruct, EFieldIteratorFlags::ExcludeSuper); props; ++props) {
+      collectClassRefs(*props, classes);
+    }
+    break;
+  case ETypeKind::KUDelegate:
+    edges.Append(getBodyEdges(inEntry.udelegate->delegateSignature));
+    for (TFieldIterator<UProperty> params(inEntry.udelegate->delegateSignature); params; ++params) {
+      collectClassRefs(*params, classes);
+    }
+    break;
+  default: {
+    UClass *uclass = inEntry.cls->uclass;
+    classes.Add(uclass->GetSuperClass());
+    for (auto& iface : uclass->Interfaces) {
+      classes.Add(iface.Class);
+    }
+    for (TFieldIterator<UProperty> props(uclass, EFieldIteratorFlags::ExcludeSuper); props; ++props) {
+      collectEdges(*props, false, edges);
+      collectClassRefs(*props, classes);
+    }
+    for (TFieldIterator<UFunction> funcs(uclass, EFieldIteratorFlags::ExcludeSuper); funcs; ++funcs) {
+      for (TFieldIterator<UProperty> args(*funcs); args; ++args) {
+        collectEdges(*args, true, edges);
+        collectClassRefs(*args, classes);
+      }
+    }
+    break;
+  }
+  }
+
+  // types that were never touched (e.g. `UHX_Internal` ones) aren't in the type table
+  for (const auto& edge : edges) {
+    const NonClassDescriptor *target = nullptr;
+    switch (edge.kind) {
+    case ETypeKind::KUStruct:
+      target = m_structs.FindRef(static_cast<UScriptStruct *>(edge.target));
+      break;
+    case ETypeKind::KUEnum:
+      target = m_enums.FindRef(static_cast<UEnum *>(edge.target));
+      break;
+    case ETypeKind::KUDelegate:
+      target = m_delegates.FindRef(static_cast<UFunction *>(edge.target));
+      break;
+    default:
+      check(false);
+    }
+    if (target != nullptr) {
+      outIds.Add(target->id);
+    }
+  }
+  for (UClass *cls : classes) {
+    auto target = m_classes.FindRef(cls);
+    if (target != nullptr) {
+      outIds.Add(target->id);
+    }
+  }
+}
+
+int32 FHaxeTypes::exportOnlyReachable(TFunctionRef<bool (const FHaxeTypeEntry&)> inIsRoot, TFunctionRef<bool (const FHaxeTypeEntry&)> inIsGenerated) {
+  TBitArray<> reached(false, m_typeTable.Num());
+  TArray<int32> pending;
+  auto reach = [&](int32 inId) {
+    if (!reached[inId]) {
+      reached[inId] = true;
+      pending.Push(inId);
+    }
+  };
+
+  for (int32 id = 0; id < m_typeTable.Num(); id++) {
+    if (inIsRoot(m_typeTable[id])) {
+      reach(id);
+    }
+  }
+
+  TArray<int32> dependencies;
+  while (pending.Num() > 0) {
+    const FHaxeTypeEntry& entry = m_typeTable[pending.Pop(false)];
+    if (!inIsGenerated(entry)) {
+      continue;
+    }
+    dependencies.Reset();
+    getDependencies(entry, dependencies);
+    for (int32 id : dependencies) {
+      reach(id);
+    }
+  }
+
+  int32 ret = 0;
+  for (int32 id = 0; id < m_typeTable.Num(); id++) {
+    auto& entry = m_typeTable[id];
+    if (!reached[id] && entry.exported && inIsGenerated(entry)) {
+      entry.exported = false;
+      ret++;
+    }
+  }
+  return ret;
+}
@@ -0,0 +1,150 @@
+#include "HaxeWriteQueue.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/ScopeLock.h"
+
+FHaxeWriteQueue::FHaxeWriteQueue(FWriter inWriter, int32 inNumWorkers, int32 inCapacity) :
+  m_writer(inWriter),
+  m_numWorkers(inNumWorkers),
+  m_head(0),
+  m_count(0),
+  m_pending(0),
+  m_stopping(false),
+  m_failed(false)
+{
+  m_jobs.SetNum(FMath::Max(inCapacity, 1));
+  m_workAvailable = FPlatformProcess::GetSynchEventFromPool(false);
+  m_spaceAvailable = FPlatformProcess::GetSynchEventFromPool(false);
+  m_idle = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FHaxeWriteQueue::~FHaxeWriteQueue() {
+  FString error;
+  drain(error);
+  FPlatformProcess::ReturnSynchEventToPool(m_workAvailable);
+  FPlatformProcess::ReturnSynchEventToPool(m_spaceAvailable);
+  FPlatformProcess::ReturnSynchEventToPool(m_idle);
+}
+
+uint32 FHaxeWriteQueue::FWorker::Run() {
+  FHaxeWriteJob job;
+  while (m_queue.pop(job)) {
+    FString error;
+    bool success = m_queue.m_writer(job, error);
+    m_queue.finish(success, error);
+  }
+  return 0;
+}
+
+void FHaxeWriteQueue::startWorkers() {
+  for (int32 i = 0; i < m_numWorkers; i++) {
+    auto worker = new FWorker(*this);
+    auto thread = FRunnableThread::Create(worker, *FString::Printf(TEXT("HaxeExternWriter%d"), i), 0, TPri_Normal);
+    check(thread != nullptr);
+    m_workers.Add(worker);
+    m_threads.Add(thread);
+  }
+}
+
+void FHaxeWriteQueue::stopWorkers() {
+  if (m_threads.Num() == 0) {
+    return;
+  }
+  {
+    FScopeLock lock(&m_lock);
+    m_stopping = true;
+  }
+  // each worker wakes up the next one when it stops
+  m_workAvailable->Trigger();
+  for (int32 i = 0; i < m_threads.Num(); i++) {
+    m_threads[i]->WaitForCompletion();
+    delete m_threads[i];
+    delete m_workers[i];
+  }
+  m_threads.Reset();
+  m_workers.Reset();
+  m_stopping = false;
+}
+
+bool FHaxeWriteQueue::pop(FHaxeWriteJob& outJob) {
+  while (true) {
+    {
+      FScopeLock lock(&m_lock);
+      if (m_count > 0) {
+        outJob = MoveTemp(m_jobs[m_head]);
+        m_head = (m_head + 1) % m_jobs.Num();
+        m_count--;
+        if (m_count > 0) {
+          // there's still work for another worker
+          m_workAvailable->Trigger();
+        }
+        m_spaceAvailable->Trigger();
+        return true;
+      }
+      if (m_stopping) {
+        m_workAvailable->Trigger();
+        return false;
+      }
+    }
+    m_workAvailable->Wait();
+  }
+}
+
+void FHaxeWriteQueue::finish(bool inSuccess, const FString& inError) {
+  FScopeLock lock(&m_lock);
+  if (!inSuccess && !m_failed) {
+    m_failed = true;
+    m_error = inError;
+  }
+  if (--m_pending == 0) {
+    m_idle->Trigger();
+  }
+}
+
+void FHaxeWriteQueue::enqueue(FHaxeWriteJob&& inJob) {
+  if (m_numWorkers <= 0) {
+    FString error;
+    bool success = m_writer(inJob, error);
+    if (!success && !m_failed) {
+      m_failed = true;
+      m_error = error;
+    }
+    return;
+  }
+
+  if (m_threads.Num() == 0) {
+    startWorkers();
+  }
+  while (true) {
+    {
+      FScopeLock lock(&m_lock);
+      if (m_count < m_jobs.Num()) {
+        m_jobs[(m_head + m_count) % m_jobs.Num()] = MoveTemp(inJob);
+        m_count++;
+        m_pending++;
+        m_workAvailable->Trigger();
+        return;
+      }
+    }
+    m_spaceAvailable->Wait();
+  }
+}
+
+bool FHaxeWriteQueue::drain(FString& outError) {
+  while (true) {
+    {
+      FScopeLock lock(&m_lock);
+      if (m_pending == 0) {
+        break;
+      }
+    }
+    m_idle->Wait();
+  }
+  stopWorkers();
+
+  FScopeLock lock(&m_lock);
+  bool success = !m_failed;
+  outError = m_error;
+  m_failed = false;
+  m_error.Empty();
+  return success;
+}
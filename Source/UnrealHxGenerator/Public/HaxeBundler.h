@@ -0,0 +1,60 @@
+#pragma once
+#include <CoreMinimal.h>
+#include "HaxeTypes.h"
+
+enum class EHaxeBundleMode {
+  // one file per type
+  None,
+  // one module per UE module and first letter of the type name
+  Letter,
+  // modules of about the same size, for each UE module
+  Size
+};
+
+/**
+ * Groups the types of each Haxe package into a bounded number of bundled Haxe modules, so the Haxe compiler
+ * doesn't need to find and open one file per type. Bundled types use the same `haxeModule` path as the types
+ * that set the `HaxeModule` metadata.
+ *
+ * Types that already have a Haxe module, types generated from Haxe and types that have an `_Extra` file
+ * are always kept in their own file
+ **/
+class FHaxeBundler {
+private:
+  EHaxeBundleMode m_mode;
+  // the approximate size of each bundle, in bytes (only used by `EHaxeBundleMode::Size`)
+  int64 m_budget;
+  // the type paths (e.g. `unreal.AActor`) that have an `_Extra` file
+  TSet<FString> m_extraTypes;
+
+  void findExtraTypes(const FString& inRoot);
+
+  static int64 estimateSize(const FHaxeTypeEntry& inEntry);
+
+public:
+  FHaxeBundler() : m_mode(EHaxeBundleMode::None), m_budget(0)
+  {
+  }
+
+  /**
+   * Reads the mode from `EXTERN_BUNDLE`, which is either `letter` or `size:<kilobytes>`.
+   * If enabled, looks for `_Extra` files in `inOutPath` and in the `;`-separated `EXTERN_EXTRA_PATHS`
+   **/
+  void init(const FString& inOutPath);
+
+  bool isEnabled() const {
+    return m_mode != EHaxeBundleMode::None;
+  }
+
+  /**
+   * Tells if `inHaxeModule` is the name of a bundle of the UE module `inModule` (e.g. `EngineTypes_A` or
+   * `EngineTypes_3` for `Engine`), in any bundle mode
+   **/
+  static bool isBundle(const FString& inHaxeModule, const FString& inModule);
+
+  /**
+   * Sets the Haxe module of every type that can be bundled, and adds their ids to `outBundled`.
+   * Must be called after all types were touched, and before any is generated
+   **/
+  void assign(FHaxeTypes& inTypes, TArray<int32>& outBundled) const;
+};
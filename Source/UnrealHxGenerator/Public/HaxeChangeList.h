@@ -0,0 +1,59 @@
+#pragma once
+#include <CoreMinimal.h>
+#include "HaxeOutputManifest.h"
+
+/**
+ * The Haxe files and types that were added, modified or removed, so that the Haxe build that consumes the
+ * externs can only invalidate what changed. It's saved at the end of every run next to the output directory
+ * (e.g. `Haxe/Externs-changes.json`):
+ *
+ *   {
+ *     "runs": 1,
+ *     "files": { "added": [...], "modified": [...], "removed": [...] },
+ *     "types": { "added": [...], "modified": [...], "removed": [...] }
+ *   }
+ *
+ * Files are full paths, and types are qualified Haxe names (e.g. `unreal.AActor`). A type is modified if a file
+ * that declares it was written, or if it moved to another file. Files that were up-to-date aren't listed.
+ *
+ * The consumer acknowledges the changes by deleting the file. Until it does, every run merges its changes into
+ * the ones already in the file, and `runs` counts how many runs it covers.
+ *
+ * It's not thread-safe: `addFile` must be called under a lock held by the caller
+ **/
+class FHaxeChangeList {
+private:
+  // the types each file declared in the last run
+  TMap<FString, TArray<FString>> m_previousFiles;
+  TSet<FString> m_previousTypes;
+  TSet<FString> m_added;
+  TSet<FString> m_modified;
+  TSet<FString> m_removed;
+
+public:
+  /**
+   * Remembers the types the manifest had, before this run changes it
+   **/
+  void begin(const FHaxeOutputManifest& inManifest);
+
+  /**
+   * Records a file that was written. `inExisted` tells if the file existed before it was written
+   **/
+  void addFile(const FString& inFile, bool inExisted) {
+    if (inExisted) {
+      m_modified.Add(inFile);
+    } else {
+      m_added.Add(inFile);
+    }
+  }
+
+  void removeFile(const FString& inFile) {
+    m_removed.Add(inFile);
+  }
+
+  /**
+   * Saves the change list, with the types the manifest has at the end of the run. If the file at `inPath`
+   * wasn't consumed yet, the changes of this run are merged into it
+   **/
+  bool save(const FString& inPath, const FHaxeOutputManifest& inManifest) const;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <CoreMinimal.h>
+#include "HaxeTypes.h"
+
+/**
+ * The forward and reverse dependencies between the exported Haxe types, as found by the touch phase
+ * (see `FHaxeTypes::getDependencies`). It's saved at the end of every run next to the output directory
+ * (e.g. `Haxe/Externs-dependencies.json`):
+ *
+ *   {
+ *     "types": {
+ *       "unreal.AActor": {
+ *         "kind": "class",
+ *         "module": "Engine",
+ *         "dependencies": ["unreal.FVector", ...],
+ *         "dependents": ["unreal.APawn", ...]
+ *       },
+ *       ...
+ *     }
+ *   }
+ *
+ * Types are qualified Haxe names. To find everything that must be rebuilt when a type changes,
+ * follow its `dependents` transitively
+ **/
+class FHaxeDependencyGraph {
+private:
+  // the ids of the types each type depends on, and of the types that depend on it - indexed by type id
+  TArray<TArray<int32>> m_dependencies;
+  TArray<TArray<int32>> m_dependents;
+
+public:
+  /**
+   * Builds the graph of the types that are exported. Must be called once the touch phase is over
+   **/
+  void build(FHaxeTypes& inTypes);
+
+  /**
+   * Saves the graph to `inPath`, unless the file already has the same contents
+   **/
+  bool save(const FHaxeTypes& inTypes, const FString& inPath) const;
+};
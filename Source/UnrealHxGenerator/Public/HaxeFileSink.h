@@ -0,0 +1,67 @@
+#pragma once
+#include <CoreMinimal.h>
+#include "Misc/SecureHash.h"
+
+/**
+ * Converts text to UTF-8 in small chunks and computes the hash of the converted bytes.
+ * If `open` was called, the bytes are also streamed into a temporary file next to the target, which is only
+ * moved over the target when `commit` is called. This way nobody (e.g. the Haxe compilation server)
+ * will ever see a half-written file
+ **/
+class FHaxeFileSink {
+private:
+  FSHA1 m_sha;
+  FArchive *m_writer;
+  FString m_target;
+  FString m_temp;
+  int64 m_size;
+
+  void writeUTF8(const ANSICHAR *inData, int32 inLen);
+
+public:
+  FHaxeFileSink() : m_writer(nullptr), m_size(0)
+  {
+  }
+
+  ~FHaxeFileSink() {
+    discard();
+  }
+
+  /**
+   * Starts streaming the contents into a temporary file that will replace `inTarget` when `commit` is called
+   **/
+  bool open(const FString& inTarget);
+
+  FHaxeFileSink& write(const TCHAR *inText, int32 inLen);
+
+  FHaxeFileSink& write(const FString& inText) {
+    return write(*inText, inText.Len());
+  }
+
+  /**
+   * The number of UTF-8 bytes written so far
+   **/
+  int64 getSize() const {
+    return m_size;
+  }
+
+  /**
+   * Returns the hash of everything written so far. Must only be called once
+   **/
+  FSHAHash finishHash() {
+    FSHAHash ret;
+    m_sha.Final();
+    m_sha.GetHash(ret.Hash);
+    return ret;
+  }
+
+  /**
+   * Closes the temporary file and moves it over the target file
+   **/
+  bool commit();
+
+  /**
+   * Closes and deletes the temporary file, if any
+   **/
+  void discard();
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <CoreMinimal.h>
+#include "Misc/SecureHash.h"
+#include "HAL/CriticalSection.h"
+#include "HaxeTypes.h"
+
+/**
+ * The output of a generated type, along with the fingerprint of the reflection data that generated it
+ **/
+struct FHaxeCachedType {
+  FSHAHash fingerprint;
+  bool generated;
+  FString contents;
+
+  FHaxeCachedType() : generated(false)
+  {
+  }
+
+  friend FArchive& operator<<(FArchive& Ar, FHaxeCachedType& inType) {
+    Ar << inType.fingerprint;
+    Ar << inType.generated;
+    Ar << inType.contents;
+    return Ar;
+  }
+};
+
+/**
+ * Caches the generated code of each type from one run to the next.
+ * Each type gets a fingerprint that covers everything that `FHaxeGenerator` reads to generate it:
+ * its flags, metadata, fields, super chain, and the Haxe names of all the types it references.
+ * If the fingerprint is the same as the last run's, the cached code can be used instead of generating it again.
+ *
+ * `fingerprint` and `find` can be called concurrently during generation; `add` must be called serially
+ **/
+class FHaxeGenerationCache {
+private:
+  FString m_path;
+  TMap<FString, FHaxeCachedType> m_previous;
+  TMap<FString, FHaxeCachedType> m_current;
+  // the hash of the field names of each class and of its supers, so that a super is only walked once
+  // no matter how many classes extend it
+  mutable FRWLock m_fieldNamesLock;
+  mutable TMap<const UClass *, FSHAHash> m_fieldNames;
+
+  FSHAHash getFieldNamesHash(UClass *inClass) const;
+
+public:
+  void load(const FString& inPath);
+  bool save();
+
+  static FString getKey(const ClassDescriptor *inDesc) {
+    return inDesc->uclass->GetPathName();
+  }
+
+  static FString getKey(const StructDescriptor *inDesc) {
+    return inDesc->ustruct->GetPathName();
+  }
+
+  static FString getKey(const EnumDescriptor *inDesc) {
+    return inDesc->uenum->GetPathName();
+  }
+
+  static FString getKey(const DelegateDescriptor *inDesc) {
+    return inDesc->delegateSignature->GetPathName();
+  }
+
+  FSHAHash fingerprint(const FHaxeTypes& inTypes, const ClassDescriptor *inDesc) const;
+  FSHAHash fingerprint(const FHaxeTypes& inTypes, const StructDescriptor *inDesc) const;
+  FSHAHash fingerprint(const FHaxeTypes& inTypes, const EnumDescriptor *inDesc) const;
+  FSHAHash fingerprint(const FHaxeTypes& inTypes, const DelegateDescriptor *inDesc) const;
+
+  /**
+   * Returns the cached type from the last run if its fingerprint is still `inFingerprint`
+   **/
+  const FHaxeCachedType *find(const FString& inKey, const FSHAHash& inFingerprint) const {
+    auto found = m_previous.Find(inKey);
+    if (found != nullptr && found->fingerprint == inFingerprint) {
+      return found;
+    }
+    return nullptr;
+  }
+
+  void add(const FString& inKey, const FHaxeCachedType& inType) {
+    m_current.Add(inKey, inType);
+  }
+};
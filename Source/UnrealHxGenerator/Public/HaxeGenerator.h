@@ -1,5 +1,7 @@
 #pragma once
 #include <CoreMinimal.h>
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
 #include "HaxeTypes.h"
 
 namespace HaxeGenerator {
@@ -39,37 +41,72 @@ struct Comment {
 class FHelperBuf {
 private:
   int32 m_indents;
-  FString m_indent;
   FString m_buf;
 
   bool m_hasContent = false;
 
+  void appendChars(const TCHAR *inText, int32 inLen) {
+    if (inLen > 0) {
+      this->m_buf.AppendChars(inText, inLen);
+      this->m_hasContent = true;
+    }
+  }
+
+  void appendIndent() {
+    static const TCHAR spaces[] = TEXT("                                                                ");
+    static const int32 maxSpaces = ARRAY_COUNT(spaces) - 1;
+    int32 toAdd = m_indents * 2;
+    while (toAdd > 0) {
+      int32 len = toAdd < maxSpaces ? toAdd : maxSpaces;
+      this->m_buf.AppendChars(spaces, len);
+      toAdd -= len;
+    }
+  }
+
 public:
-  FHelperBuf() {
+  FHelperBuf() : m_indents(0)
+  {
   }
 
-  FHelperBuf(FString inBuf) : m_buf(inBuf)
+  FHelperBuf(FString inBuf) : m_indents(0), m_buf(inBuf)
   {
   }
 
-  FHelperBuf& newline() {
+  /**
+   * Makes sure the buffer can hold at least `inSize` characters without growing
+   **/
+  void reserve(int32 inSize) {
+    this->m_buf.Reserve(inSize);
+  }
+
+  /**
+   * Empties the buffer so it can be reused, but keeps its allocated memory
+   **/
+  void reset() {
+    this->m_buf.Reset();
+    this->m_indents = 0;
     this->m_hasContent = false;
-    return *this << "\n" << m_indent;
+  }
+
+  FHelperBuf& newline() {
+    this->m_buf += TCHAR('\n');
+    this->appendIndent();
+    this->m_hasContent = true;
+    return *this;
   }
 
   FHelperBuf& begin(const TCHAR *inBr=TEXT("{")) {
     m_indents++;
-    m_indent += TEXT("  ");
     if (!*inBr) {
       return *this;
     }
 
-    return *this << inBr << "\n" << m_indent;
+    *this << inBr;
+    return this->newline();
   }
 
   FHelperBuf& end(const TCHAR *inBr=TEXT("}")) {
     m_indents--;
-    m_indent = this->m_indent.LeftChop(2);
     if (*inBr) {
       this->newline();
       *this << inBr;
@@ -84,15 +121,17 @@ public:
   }
 
   FHelperBuf& addNewlines(const FString& inText, bool inAddNewlineAfter=false) {
-    FString left;
-    FString right = inText;
-    static const FString nl = TEXT("\n");
-    while (right.Split(nl, &left, &right, ESearchCase::CaseSensitive, ESearchDir::FromStart)) {
-      *this << left;
-      this->newline();
+    const TCHAR *start = *inText;
+    const TCHAR *cur = start;
+    for (; *cur; cur++) {
+      if (*cur == TCHAR('\n')) {
+        this->appendChars(start, cur - start);
+        this->newline();
+        start = cur + 1;
+      }
     }
-    if (!right.IsEmpty()) {
-      *this << right;
+    if (cur != start) {
+      this->appendChars(start, cur - start);
       if (inAddNewlineAfter) {
         this->newline();
       }
@@ -106,7 +145,11 @@ public:
       this->newline();
     }
     this->begin(TEXT("/**"));
-    this->addNewlines(inText.Replace(TEXT("*/"), TEXT("*")), false);
+    if (inText.Contains(TEXT("*/"), ESearchCase::CaseSensitive)) {
+      this->addNewlines(inText.Replace(TEXT("*/"), TEXT("*")), false);
+    } else {
+      this->addNewlines(inText, false);
+    }
     this->end(TEXT("**/"));
 
     return *this;
@@ -162,28 +205,171 @@ public:
     }
   }
 
-  FString toString() {
+  const FString& toString() const {
     return m_buf;
   }
 
+  /**
+   * Copies the contents of this buffer into `outStr`, and resets the buffer. The contents are copied rather than
+   * moved so that the buffer keeps its memory, and a reused buffer doesn't have to grow again for the next type
+   **/
+  void copyTo(FString& outStr) {
+    outStr = this->m_buf;
+    this->reset();
+  }
+
   void addTo(FString &str) {
     str += this->m_buf;
   }
 };
 
+/**
+ * The structural description of a property's type: its property class, the relevant property flags,
+ * the type it references (struct, class, enum or delegate signature) and the same for its inner properties.
+ * Two properties with the same key will always get the same Haxe type
+ **/
+struct FPropTypeKey {
+  TArray<UPTRINT, TInlineAllocator<12>> parts;
+  uint32 hash;
+
+  FPropTypeKey() : hash(0)
+  {
+  }
+
+  bool operator==(const FPropTypeKey& inOther) const {
+    return hash == inOther.hash && parts == inOther.parts;
+  }
+
+  friend uint32 GetTypeHash(const FPropTypeKey& inKey) {
+    return inKey.hash;
+  }
+
+  static FPropTypeKey fromProperty(UProperty *inProp);
+};
+
+/**
+ * Memoizes the Haxe type of each distinct property type, including the types that aren't supported.
+ * It's shared by all generators, and can be used from any thread
+ **/
+class FHaxeTypeStringCache {
+private:
+  struct FEntry {
+    bool supported;
+    FString type;
+  };
+
+  mutable FRWLock m_lock;
+  TMap<FPropTypeKey, FEntry> m_entries;
+
+public:
+  /**
+   * If `inKey` was already resolved, sets `outSupported` and appends its type to `outType`
+   **/
+  bool find(const FPropTypeKey& inKey, bool& outSupported, FString& outType) const {
+    m_lock.ReadLock();
+    auto found = m_entries.Find(inKey);
+    if (found != nullptr) {
+      outSupported = found->supported;
+      outType += found->type;
+    }
+    m_lock.ReadUnlock();
+    return found != nullptr;
+  }
+
+  void add(const FPropTypeKey& inKey, bool inSupported, const FString& inType) {
+    m_lock.WriteLock();
+    FEntry& entry = m_entries.FindOrAdd(inKey);
+    entry.supported = inSupported;
+    entry.type = inType;
+    m_lock.WriteUnlock();
+  }
+
+  /**
+   * Must be called whenever the set of known types changes (e.g. when a delegate is not exported)
+   **/
+  void reset() {
+    m_lock.WriteLock();
+    m_entries.Reset();
+    m_lock.WriteUnlock();
+  }
+};
+
+/**
+ * The names of the fields declared by a struct (but not by its supers), linked to the names of its super struct.
+ * Every struct that has the same super shares its names, so a class hierarchy is only walked once
+ **/
+struct FHaxeFieldNames {
+  const FHaxeFieldNames *super;
+  TSet<FName> names;
+
+  FHaxeFieldNames(const FHaxeFieldNames *inSuper) : super(inSuper)
+  {
+  }
+
+  /**
+   * Returns true if `inName` is declared by this struct or by any of its supers
+   **/
+  bool contains(FName inName) const {
+    for (auto node = this; node != nullptr; node = node->super) {
+      if (node->names.Contains(inName)) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+/**
+ * Keeps the field names of each struct that was used as a super. It's shared by all generators,
+ * and can be used from any thread
+ **/
+class FHaxeFieldNameCache {
+private:
+  mutable FRWLock m_lock;
+  TMap<const UStruct *, const FHaxeFieldNames *> m_nodes;
+  // the nodes are never moved, as they are referenced by their children
+  THaxeArena<FHaxeFieldNames> m_arena;
+
+public:
+  /**
+   * The names of the fields of `inStruct` and of its supers, or nullptr if `inStruct` is nullptr
+   **/
+  const FHaxeFieldNames *get(UStruct *inStruct);
+};
+
 class FHaxeGenerator {
 private:
   FHelperBuf m_buf;
-  FHaxeTypes& m_haxeTypes;
+  // scratch buffer for the function currently being generated
+  FHelperBuf m_funcBuf;
+  const FHaxeTypes& m_haxeTypes;
+  FHaxeTypeStringCache *m_typeCache;
+  // only set if no shared cache was passed to the constructor
+  TUniquePtr<FHaxeFieldNameCache> m_ownFieldNames;
+  FHaxeFieldNameCache *m_fieldNames;
   bool m_hasStructs;
-  TSet<FString> m_generatedFields;
+  // the fields of the super class of the class being generated
+  const FHaxeFieldNames *m_superFields;
+  // the functions generated so far for the class being generated
+  TSet<FName> m_generatedFields;
+
+  bool isFieldGenerated(FName inName) const {
+    return m_generatedFields.Contains(inName) || (m_superFields != nullptr && m_superFields->contains(inName));
+  }
 
-  void collectSuperFields(UStruct *inSuper);
+  void reserveFor(UStruct *inStruct);
 public:
-  FHaxeGenerator(FHaxeTypes& inTypes) :
+  FHaxeGenerator(const FHaxeTypes& inTypes, FHaxeTypeStringCache *inTypeCache=nullptr, FHaxeFieldNameCache *inFieldNames=nullptr) :
     m_buf(FHelperBuf()),
-    m_haxeTypes(inTypes)
+    m_haxeTypes(inTypes),
+    m_typeCache(inTypeCache),
+    m_fieldNames(inFieldNames),
+    m_superFields(nullptr)
   {
+    if (m_fieldNames == nullptr) {
+      m_ownFieldNames = MakeUnique<FHaxeFieldNameCache>();
+      m_fieldNames = m_ownFieldNames.Get();
+    }
   }
 
   bool generateClass(const ClassDescriptor *inClass);
@@ -191,10 +377,33 @@ public:
   bool generateEnum(const EnumDescriptor *inEnum);
   bool generateDelegate(const DelegateDescriptor *inDelegate);
 
-  FString toString() {
+  const FString& toString() const {
     return m_buf.toString();
   }
 
+  void copyTo(FString& outStr) {
+    m_buf.copyTo(outStr);
+  }
+
+  /**
+   * Clears the generated code and state, so this generator can be used for another type.
+   * Already allocated memory is kept
+   **/
+  void reset() {
+    m_buf.reset();
+    m_funcBuf.reset();
+    m_generatedFields.Reset();
+    m_superFields = nullptr;
+  }
+
+  /**
+   * Gets the Haxe type of a property or function parameter, exactly as the generated code declares it.
+   * Returns false if the type is not supported (and the field isn't generated)
+   **/
+  bool resolvePropertyType(UProperty *inProp, FString& outType) {
+    return upropType(inProp, outType);
+  }
+
   static FString getHeaderPath(UPackage *inPack, const FString& inPath);
 
 protected:
@@ -205,10 +414,49 @@ protected:
   // Gets the Haxe representation for a `UProperty` type. This is used both for uproperties and for ufunction arguments
   // Returns an empty string if the type is not supported
   bool upropType(UProperty* inProp, FString &outType);
+  // Same as `upropType`, but never uses the type cache
+  bool resolveUPropType(UProperty* inProp, FString &outType);
   bool isReadOnly(UProperty* inProp);
 
   void generateFields(UStruct *inStruct, bool onlyProps);
   void generateIncludeMetas(const NonClassDescriptor *inDesc);
 };
 
+/**
+ * Keeps the generators (and their buffers) around so they can be reused by other types.
+ * `acquire` and `release` can be called from any thread
+ **/
+class FHaxeGeneratorPool {
+private:
+  const FHaxeTypes& m_haxeTypes;
+  FHaxeTypeStringCache *m_typeCache;
+  FHaxeFieldNameCache m_fieldNames;
+  FCriticalSection m_lock;
+  TArray<FHaxeGenerator *> m_free;
+  TIndirectArray<FHaxeGenerator> m_all;
+
+public:
+  FHaxeGeneratorPool(const FHaxeTypes& inTypes, FHaxeTypeStringCache *inTypeCache=nullptr) :
+    m_haxeTypes(inTypes),
+    m_typeCache(inTypeCache)
+  {
+  }
+
+  FHaxeGenerator *acquire() {
+    FScopeLock lock(&m_lock);
+    if (m_free.Num() > 0) {
+      return m_free.Pop(false);
+    }
+    auto ret = new FHaxeGenerator(m_haxeTypes, m_typeCache, &m_fieldNames);
+    m_all.Add(ret);
+    return ret;
+  }
+
+  void release(FHaxeGenerator *inGen) {
+    inGen->reset();
+    FScopeLock lock(&m_lock);
+    m_free.Push(inGen);
+  }
+};
+
 }
@@ -0,0 +1,100 @@
+#pragma once
+#include <CoreUObject.h>
+
+/**
+ * Decides which modules and types are generated. It's built from `EXTERN_MODULES`, `UNREAL_EXTERN_MODULES` and an
+ * optional ini file (see `load`), and compiled into hashed sets and simple matchers.
+ * There is a single instance, as the checks are made from static helpers; it's read-only after `load`,
+ * and can be used from any thread. The decision for each module is also kept in its `FHaxePackageInfo`, which is
+ * what the generation loops check
+ **/
+class FHaxeGeneratorConfig {
+private:
+  /**
+   * A module name pattern, where `*` matches any sequence of characters. Patterns that only have a leading
+   * or a trailing `*` are matched without `MatchesWildcard`
+   **/
+  struct FPattern {
+    enum class EKind : uint8 {
+      Prefix,
+      Suffix,
+      Wildcard
+    };
+
+    EKind kind;
+    FString text;
+
+    static FPattern compile(const FString& inGlob);
+    bool matches(const FString& inName) const;
+  };
+
+  enum EDecision : uint8 {
+    // the module is one of the game modules we generate
+    DGame = 1,
+    // the module is an engine or plugin module that we also generate
+    DUnreal = 2
+  };
+
+  TSet<FString> m_modules;
+  TSet<FString> m_unrealModules;
+  TArray<FPattern> m_include;
+  TArray<FPattern> m_unrealInclude;
+  TArray<FPattern> m_exclude;
+  TSet<FName> m_noCopyStructs;
+  TSet<FName> m_unsupportedElements;
+  FString m_path;
+
+  static bool matchesAny(const TArray<FPattern>& inPatterns, const FString& inName);
+  uint8 decide(const FString& inName) const;
+
+  FHaxeGeneratorConfig();
+
+public:
+  static FHaxeGeneratorConfig& get();
+
+  /**
+   * Reads the ini file at `inPath` (if it exists) on top of the environment variables. The file may have:
+   *
+   *   [Modules]
+   *   ; game modules to generate, in addition to EXTERN_MODULES
+   *   +Include=MyGame*
+   *   ; engine or plugin modules to generate, in addition to UNREAL_EXTERN_MODULES
+   *   +UnrealInclude=MyPlugin*
+   *   ; modules that are never generated
+   *   +Exclude=*Editor
+   *
+   *   [Types]
+   *   ; structs that can't be copied (by their UE name, without prefix)
+   *   +NoCopy=TickFunction
+   *   ; types that can't be used in a TArray, TMap or TSet
+   *   +UnsupportedElement=StaticMeshComponentLODInfo
+   *
+   * Must be called before any type is touched
+   **/
+  void load(const FString& inPath);
+
+  /**
+   * The path of the ini file that was read, or an empty string if there was none
+   **/
+  const FString& getPath() const {
+    return m_path;
+  }
+
+  bool isCompilingGameCode() const {
+    return m_modules.Num() > 0 || m_include.Num() > 0;
+  }
+
+  bool shouldGenerateModule(const FString& inName, bool inAlsoUnrealTypes) const {
+    uint8 decision = decide(inName);
+    return (decision & DGame) != 0 || (inAlsoUnrealTypes && (decision & DUnreal) != 0);
+  }
+
+  bool structHasCopy(const UStruct *inStruct) const {
+    return !m_noCopyStructs.Contains(inStruct->GetFName());
+  }
+
+  /**
+   * Returns false if the type of `inProp` can't be used as a container element
+   **/
+  bool isSupportedElement(const class UProperty *inProp) const;
+};
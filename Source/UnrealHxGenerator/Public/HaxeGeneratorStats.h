@@ -0,0 +1,130 @@
+#pragma once
+#include <CoreMinimal.h>
+#include "HAL/PlatformTime.h"
+
+/**
+ * Records how long each phase of a generator run takes, how much output each module produces and which types
+ * took the longest to generate. UHT filters our logs, so this is saved as a JSON report instead, along with an
+ * optional Chrome trace (open it in `chrome://tracing`).
+ *
+ * It's not thread-safe: results of parallel work must be recorded after the work is done, or (for `addFile`)
+ * under a lock held by the caller
+ **/
+class FHaxeGeneratorStats {
+public:
+  struct FPhase {
+    FString name;
+    double seconds;
+    int64 count;
+  };
+
+  struct FModuleOutput {
+    int64 files;
+    int64 filesWritten;
+    int64 bytes;
+    int64 bytesWritten;
+
+    FModuleOutput() : files(0), filesWritten(0), bytes(0), bytesWritten(0)
+    {
+    }
+  };
+
+  struct FTypeTime {
+    FString name;
+    const TCHAR *kind;
+    double seconds;
+    bool cached;
+  };
+
+  struct FTraceEvent {
+    FString name;
+    const TCHAR *category;
+    double start;
+    double seconds;
+    uint32 threadId;
+  };
+
+private:
+  double m_start;
+  bool m_trace;
+  // phases are kept in the order they were first recorded
+  TArray<FPhase> m_phases;
+  TMap<FString, FModuleOutput> m_modules;
+  TArray<FTypeTime> m_types;
+  TArray<FTraceEvent> m_events;
+
+  FPhase& findPhase(const TCHAR *inName);
+
+public:
+  FHaxeGeneratorStats() : m_start(FPlatformTime::Seconds()), m_trace(false)
+  {
+  }
+
+  /**
+   * Starts the clock. If `inTrace` is set, every recorded time is also kept as a trace event
+   **/
+  void start(bool inTrace) {
+    m_start = FPlatformTime::Seconds();
+    m_trace = inTrace;
+  }
+
+  /**
+   * Returns true if trace events are kept, in which case they can be given a name
+   **/
+  bool isTracing() const {
+    return m_trace;
+  }
+
+  /**
+   * Adds the time between `inStart` and `inEnd` (from `FPlatformTime::Seconds`) to `inPhase`.
+   * `inEvent` is the name of the trace event; it defaults to the phase name
+   **/
+  void addPhase(const TCHAR *inPhase, double inStart, double inEnd, int64 inCount=1, const FString& inEvent=FString());
+
+  /**
+   * Adds a single piece of work that was done by `inThreadId` to `inPhase`. Phases recorded this way add up the time
+   * of all the threads, so they may take longer than the run itself
+   **/
+  void addWork(const TCHAR *inPhase, const FString& inEvent, double inStart, double inEnd, uint32 inThreadId);
+
+  /**
+   * Records the time it took to generate a single type (or to find it in the generation cache)
+   **/
+  void addType(const TCHAR *inKind, const FString& inName, double inStart, double inEnd, uint32 inThreadId, bool inCached);
+
+  /**
+   * Records a file that was output by `inModule`, whether it needed to be written or not
+   **/
+  void addFile(const FString& inModule, int64 inBytes, bool inWritten);
+
+  /**
+   * Saves the JSON report, including the `inSlowest` types that took the longest to generate.
+   * The trace is only saved if tracing was enabled in `start`
+   **/
+  bool save(const FString& inReportPath, const FString& inTracePath, int32 inSlowest) const;
+};
+
+/**
+ * Adds the time between its construction and destruction to a phase
+ **/
+class FHaxeStatsScope {
+private:
+  FHaxeGeneratorStats& m_stats;
+  const TCHAR *m_phase;
+  double m_start;
+
+public:
+  int64 count;
+
+  FHaxeStatsScope(FHaxeGeneratorStats& inStats, const TCHAR *inPhase) :
+    m_stats(inStats),
+    m_phase(inPhase),
+    m_start(FPlatformTime::Seconds()),
+    count(1)
+  {
+  }
+
+  ~FHaxeStatsScope() {
+    m_stats.addPhase(m_phase, m_start, FPlatformTime::Seconds(), count);
+  }
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <CoreMinimal.h>
+#include "Misc/SecureHash.h"
+
+/**
+ * Keeps the hash of the last contents written to each generated file, so we can tell if a file
+ * is up-to-date without having to read it back from disk, along with the Haxe types each file declares.
+ * It is persisted as a text file inside `EXTERN_OUTPUT_DIR`
+ **/
+class FHaxeOutputManifest {
+private:
+  struct FEntry {
+    FSHAHash hash;
+    // the qualified names of the Haxe types declared in the file
+    TArray<FString> types;
+  };
+
+  FString m_path;
+  TMap<FString, FEntry> m_entries;
+  bool m_dirty;
+  bool m_loaded;
+
+public:
+  FHaxeOutputManifest() : m_dirty(false), m_loaded(false)
+  {
+  }
+
+  /**
+   * Loads the manifest at `inPath`. If the manifest doesn't exist or is corrupt, it starts empty - so every file
+   * will be rewritten. If `inOutRoot` doesn't exist anymore (e.g. the externs were deleted by hand), only the files
+   * inside it are forgotten
+   **/
+  void load(const FString& inPath, const FString& inOutRoot);
+
+  /**
+   * Saves the manifest, if anything changed since it was loaded
+   **/
+  bool save();
+
+  bool isUpToDate(const FString& inFile, const FSHAHash& inHash) const {
+    auto found = m_entries.Find(inFile);
+    return found != nullptr && found->hash == inHash;
+  }
+
+  void update(const FString& inFile, const FSHAHash& inHash) {
+    m_entries.FindOrAdd(inFile).hash = inHash;
+    m_dirty = true;
+  }
+
+  /**
+   * Sets the Haxe types declared in `inFile`, which must already be in the manifest
+   **/
+  void setTypes(const FString& inFile, const TArray<FString>& inTypes) {
+    auto found = m_entries.Find(inFile);
+    if (found != nullptr && found->types != inTypes) {
+      found->types = inTypes;
+      m_dirty = true;
+    }
+  }
+
+  const TArray<FString> *getTypes(const FString& inFile) const {
+    auto found = m_entries.Find(inFile);
+    return found != nullptr ? &found->types : nullptr;
+  }
+
+  bool contains(const FString& inFile) const {
+    return m_entries.Contains(inFile);
+  }
+
+  void remove(const FString& inFile) {
+    if (m_entries.Remove(inFile) > 0) {
+      m_dirty = true;
+    }
+  }
+
+  /**
+   * Returns true if the manifest was read from disk, so it knows every file written by the previous runs
+   **/
+  bool isLoaded() const {
+    return m_loaded;
+  }
+
+  /**
+   * Adds every file that's inside the directory `inRoot` (a standard filename) to `outFiles`
+   **/
+  void getFilesUnder(const FString& inRoot, TArray<FString>& outFiles) const;
+
+  /**
+   * Adds every file in the manifest to `outTypes`, along with the types it declares
+   **/
+  void getAllTypes(TMap<FString, TArray<FString>>& outTypes) const;
+};
@@ -0,0 +1,163 @@
+#pragma once
+#include <CoreUObject.h>
+#include "HaxeTypes.h"
+
+/**
+ * A snapshot file starts with `HAXE_SNAPSHOT_MAGIC` and `HAXE_SNAPSHOT_VERSION`, followed by the array of
+ * `FHaxeSnapshotType` and the array of `FHaxeSnapshotExport`, serialized with `FArchive`.
+ *
+ * Whenever the layout changes, `HAXE_SNAPSHOT_VERSION` must be incremented
+ **/
+#define HAXE_SNAPSHOT_MAGIC 0x53584855 // "UHXS"
+#define HAXE_SNAPSHOT_VERSION 1
+
+/**
+ * A property as it was seen by the generator. Container and enum properties have their inner properties in `inner`
+ * (the inner property of an array, the key and value of a map, the element of a set, or the underlying
+ * property of an enum)
+ **/
+struct FHaxeSnapshotProperty {
+  FString name;
+  // the path of the property class (e.g. `/Script/CoreUObject.IntProperty`)
+  FString propClass;
+  uint64 flags;
+  int32 arrayDim;
+  bool isPublic;
+  bool isNativeBool;
+  // the path of the type it references (e.g. the struct of a struct property), or an empty string
+  FString type;
+  TArray<FHaxeSnapshotProperty> inner;
+  TArray<FString> metaKeys;
+  TArray<FString> metaValues;
+
+  FHaxeSnapshotProperty() : flags(0), arrayDim(1), isPublic(true), isNativeBool(true)
+  {
+  }
+
+  friend FArchive& operator<<(FArchive& Ar, FHaxeSnapshotProperty& inProp) {
+    Ar << inProp.name;
+    Ar << inProp.propClass;
+    Ar << inProp.flags;
+    Ar << inProp.arrayDim;
+    Ar << inProp.isPublic;
+    Ar << inProp.isNativeBool;
+    Ar << inProp.type;
+    Ar << inProp.inner;
+    Ar << inProp.metaKeys;
+    Ar << inProp.metaValues;
+    return Ar;
+  }
+};
+
+enum class EHaxeSnapshotKind : uint8 {
+  Class,
+  Struct,
+  Enum,
+  // a delegate signature
+  Delegate,
+  // a function of a class
+  Function,
+};
+
+/**
+ * A class, struct, enum, delegate signature or function. Records are saved so that the outer of a type
+ * always comes before it
+ **/
+struct FHaxeSnapshotType {
+  EHaxeSnapshotKind kind;
+  // the path of its outer: a package, or the class that declares a function or delegate
+  FString outer;
+  FString name;
+  FString super;
+  // the class, struct or function flags
+  uint32 flags;
+  TArray<FString> interfaces;
+  TArray<FHaxeSnapshotProperty> props;
+  // the names of all the fields of a class, in the order they were declared
+  TArray<FString> children;
+
+  // enums only
+  TArray<FString> enumNames;
+  TArray<int64> enumValues;
+  uint8 cppForm;
+  FString cppType;
+
+  TArray<FString> metaKeys;
+  TArray<FString> metaValues;
+
+  FHaxeSnapshotType() : kind(EHaxeSnapshotKind::Class), flags(0), cppForm(0)
+  {
+  }
+
+  FString getPath() const {
+    // functions and delegates declared in a class are subobjects of the class (e.g. `/Script/Engine.Actor:ReceiveTick`)
+    return outer + (outer.Contains(TEXT(".")) ? TEXT(":") : TEXT(".")) + name;
+  }
+
+  friend FArchive& operator<<(FArchive& Ar, FHaxeSnapshotType& inType) {
+    uint8 kind = (uint8) inType.kind;
+    Ar << kind;
+    inType.kind = (EHaxeSnapshotKind) kind;
+    Ar << inType.outer;
+    Ar << inType.name;
+    Ar << inType.super;
+    Ar << inType.flags;
+    Ar << inType.interfaces;
+    Ar << inType.props;
+    Ar << inType.children;
+    Ar << inType.enumNames;
+    Ar << inType.enumValues;
+    Ar << inType.cppForm;
+    Ar << inType.cppType;
+    Ar << inType.metaKeys;
+    Ar << inType.metaValues;
+    return Ar;
+  }
+};
+
+/**
+ * A call to `ExportClass`, along with the module that was being exported
+ **/
+struct FHaxeSnapshotExport {
+  FString classPath;
+  FString header;
+  FString module;
+
+  friend FArchive& operator<<(FArchive& Ar, FHaxeSnapshotExport& inExport) {
+    Ar << inExport.classPath;
+    Ar << inExport.header;
+    Ar << inExport.module;
+    return Ar;
+  }
+};
+
+/**
+ * Dumps the reflection data the generator reads (packages, classes, structs, enums, delegate signatures,
+ * their properties, flags and metadata, and the headers and modules UHT passed to `ExportClass`) to a file,
+ * so the generator can run again on the same types without UHT (see `Programs/UnrealHxReplay`).
+ *
+ * When `EXTERN_SNAPSHOT` is set to a path, the plugin records every `ExportClass` call and saves the snapshot
+ * once all types were touched. The snapshot has every type in the type table, plus every type they reference
+ **/
+class FHaxeReflectionSnapshot {
+private:
+  TArray<FHaxeSnapshotType> m_types;
+  TArray<FHaxeSnapshotExport> m_exports;
+  TMap<const UObject *, int32> m_typeIds;
+  TArray<UClass *> m_exportClasses;
+
+  void addType(UObject *inType);
+  void addProperty(UProperty *inProp, FHaxeSnapshotProperty& outProp);
+  FString addReference(UObject *inType);
+
+public:
+  /**
+   * Records a call to `ExportClass`
+   **/
+  void record(UClass *inClass, const FString& inHeader, const FString& inModule);
+
+  /**
+   * Saves the recorded classes and every type in `inTypes` (and everything they reference) to `inPath`
+   **/
+  bool save(const FHaxeTypes& inTypes, const FString& inPath);
+};
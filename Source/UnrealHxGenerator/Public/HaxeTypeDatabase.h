@@ -0,0 +1,155 @@
+#pragma once
+#include <CoreMinimal.h>
+#include "HaxeTypes.h"
+
+namespace HaxeGenerator {
+  class FHaxeGenerator;
+}
+
+/**
+ * The binary type database (e.g. `Haxe/Externs.typedb`) has everything the generator knew about the types
+ * it generated, so tools can look types up without parsing the generated Haxe code.
+ *
+ * The file is meant to be memory-mapped: it's little-endian, every record has a fixed size and natural alignment,
+ * and every offset is relative to the start of the file. It's laid out as:
+ *
+ *   FHaxeTypeDbHeader
+ *   FHaxeTypeDbModule[moduleCount]
+ *   FHaxeTypeDbType[typeCount]     - sorted by module, then by qualified name
+ *   FHaxeTypeDbField[fieldCount]
+ *   uint32[indexSize]              - the index by qualified name
+ *   uint32[stringCount]            - the offset of each string, relative to `stringDataOffset`
+ *   string data                    - NUL-terminated UTF-8 strings
+ *
+ * Every known type is listed, but only the types that were generated in this run have fields.
+ *
+ * Strings are referenced by their index in the string table, and string 0 is always the empty string.
+ * Types and fields are referenced by their index, and `HAXE_TYPEDB_NONE` means no reference.
+ *
+ * The index is an open-addressing hash table with a power of two size (at least twice the number of types).
+ * To find a type, hash the UTF-8 bytes of its qualified name (e.g. `unreal.AActor`, or `unreal.Mod.Name` if it's
+ * declared in a Haxe module) with 32-bit FNV-1a, and probe the buckets starting at `hash & (indexSize - 1)`.
+ * Each bucket holds the type index plus one, and an empty bucket (0) ends the search.
+ *
+ * Whenever the layout changes, `HAXE_TYPEDB_VERSION` must be incremented
+ **/
+#define HAXE_TYPEDB_MAGIC 0x54584855 // "UHXT"
+#define HAXE_TYPEDB_VERSION 1
+#define HAXE_TYPEDB_NONE 0xFFFFFFFFu
+
+struct FHaxeTypeDbHeader {
+  uint32 magic;
+  uint32 version;
+  uint32 moduleCount;
+  uint32 modulesOffset;
+  uint32 typeCount;
+  uint32 typesOffset;
+  uint32 fieldCount;
+  uint32 fieldsOffset;
+  uint32 indexSize;
+  uint32 indexOffset;
+  uint32 stringCount;
+  uint32 stringsOffset;
+  uint32 stringDataOffset;
+  uint32 stringDataSize;
+};
+
+/**
+ * A UE module (package), and the range of types that were declared in it
+ **/
+struct FHaxeTypeDbModule {
+  // e.g. `Engine`
+  uint32 name;
+  // e.g. `/Script/Engine`
+  uint32 package;
+  uint32 firstType;
+  uint32 typeCount;
+};
+
+enum class EHaxeTypeDbFlags : uint8 {
+  None = 0,
+  // the type was generated (e.g. it's not a delegate that failed to generate)
+  Exported = 1,
+  // the type is declared in Haxe code
+  HaxeGenerated = 2,
+};
+ENUM_CLASS_FLAGS(EHaxeTypeDbFlags)
+
+struct FHaxeTypeDbType {
+  // the fully qualified Haxe name, including its Haxe module
+  uint32 qualifiedName;
+  // the package and name, without its Haxe module
+  uint32 typePath;
+  uint32 name;
+  uint32 haxeModule;
+  // the name of the UE type (e.g. `AActor`)
+  uint32 uname;
+  // the C++ headers needed to use this type, separated by `;`
+  uint32 headers;
+  uint32 module;
+  // the direct super class (or struct) type
+  uint32 superType;
+  uint32 firstField;
+  uint32 fieldCount;
+  // the UE class, struct or function flags
+  uint32 ueFlags;
+  // an `ETypeKind`
+  uint8 kind;
+  EHaxeTypeDbFlags flags;
+  uint16 reserved;
+};
+
+enum class EHaxeTypeDbFieldKind : uint8 {
+  Property,
+  // followed by its `paramCount` parameters (including the return value)
+  Function,
+  Param,
+  ReturnValue,
+  EnumEntry,
+};
+
+struct FHaxeTypeDbField {
+  uint32 name;
+  // the Haxe type, or 0 if the type isn't supported (and the field wasn't generated)
+  uint32 haxeType;
+  EHaxeTypeDbFieldKind kind;
+  uint8 reserved[3];
+  uint32 paramCount;
+  // the UE property flags, function flags or the enum value
+  uint64 ueFlags;
+};
+
+static_assert(sizeof(FHaxeTypeDbHeader) == 56, "the type database header must not have padding");
+static_assert(sizeof(FHaxeTypeDbModule) == 16, "the type database modules must not have padding");
+static_assert(sizeof(FHaxeTypeDbType) == 48, "the type database types must not have padding");
+static_assert(sizeof(FHaxeTypeDbField) == 24, "the type database fields must not have padding");
+
+/**
+ * Builds the binary type database from the type table. Must be called once generation is over,
+ * so `inGen` resolves the same Haxe types that were generated
+ **/
+class FHaxeTypeDatabase {
+private:
+  TArray<FHaxeTypeDbModule> m_modules;
+  TArray<FHaxeTypeDbType> m_types;
+  TArray<FHaxeTypeDbField> m_fields;
+  TArray<uint32> m_index;
+  TMap<FString, uint32> m_stringIds;
+  TArray<uint32> m_stringOffsets;
+  TArray<uint8> m_stringData;
+
+  uint32 addString(const FString& inStr);
+  void addProperty(HaxeGenerator::FHaxeGenerator& inGen, UProperty *inProp, EHaxeTypeDbFieldKind inKind);
+  void addFields(HaxeGenerator::FHaxeGenerator& inGen, const FHaxeTypeEntry& inEntry);
+  void buildIndex(const TArray<uint32>& inHashes);
+
+public:
+  static uint32 hash(const FString& inQualifiedName);
+
+  void build(const FHaxeTypes& inTypes, HaxeGenerator::FHaxeGenerator& inGen);
+
+  /**
+   * Saves the database to `inPath`, unless the file there already has the same contents
+   **/
+  bool save(const FString& inPath) const;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <CoreUObject.h>
+#include "HaxeGeneratorConfig.h"
 DECLARE_LOG_CATEGORY_EXTERN(LogHaxeExtern, Log, All);
 
 // unfortunately we need to define the log as Log since UBT makes UHT ignore all logs that are not warnings
@@ -20,44 +21,203 @@ enum class ETypeKind {
   KUDelegate
 };
 
+/**
+ * The metadata keys read by the generator. They are converted to FNames once, instead of on every lookup
+ **/
+struct FHaxeMetaKeys {
+  const FName ToolTip;
+  const FName DisplayName;
+  const FName BlueprintGetter;
+  const FName BlueprintSetter;
+  const FName HaxeStaticClass;
+  const FName HaxeModule;
+  const FName ModuleRelativePath;
+  const FName IncludePath;
+  const FName UHX_Internal;
+
+  static const FHaxeMetaKeys& get() {
+    static const FHaxeMetaKeys keys;
+    return keys;
+  }
+
+  /**
+   * Finds the metadata `inPrefix + inName + inSuffix` in `inMap` (see `UMetaData::GetMapForObject`) without
+   * allocating. Returns nullptr if it's not there
+   **/
+  static const FString *findComposite(const TMap<FName, FString> *inMap, const TCHAR *inPrefix, const FString& inName, const TCHAR *inSuffix);
+
+private:
+  FHaxeMetaKeys() :
+    ToolTip(TEXT("ToolTip")),
+    DisplayName(TEXT("DisplayName")),
+    BlueprintGetter(TEXT("BlueprintGetter")),
+    BlueprintSetter(TEXT("BlueprintSetter")),
+    HaxeStaticClass(TEXT("HaxeStaticClass")),
+    HaxeModule(TEXT("HaxeModule")),
+    ModuleRelativePath(TEXT("ModuleRelativePath")),
+    IncludePath(TEXT("IncludePath")),
+    UHX_Internal(TEXT("UHX_Internal"))
+  {
+  }
+};
+
+/**
+ * Keeps a single copy of each string that is shared by many types (e.g. package names and paths).
+ * Interned strings are never freed, so references to them can be kept around. Thread-safe
+ **/
+struct FHaxeNamePool {
+  static const FString& intern(const FString& inStr);
+};
+
+/**
+ * A Haxe package, along with its dotted name and its path. Each distinct package has a single instance that is never
+ * freed, so every type in a package shares it. Thread-safe
+ **/
+struct FHaxePackage {
+  const TArray<FString> pack;
+  // separated by dots
+  const FString name;
+  // separated by slashes; this is the output directory of its types, relative to the externs root
+  const FString path;
+
+  FHaxePackage(const TArray<FString>& inPack) :
+    pack(inPack),
+    name(FString::Join(inPack, TEXT("."))),
+    path(FString::Join(inPack, TEXT("/")))
+  {
+  }
+
+  static const FHaxePackage& intern(const TArray<FString>& inPack);
+};
+
 struct FHaxeTypeRef {
-  TArray<FString> pack;
-  FString name;
-  FString haxeModule;
   FString uname;
   bool haxeGenerated;
   const ETypeKind kind;
   const FString module;
 
-  FHaxeTypeRef(const TArray<FString> inPack, const FString inName, ETypeKind inKind, const FString inModule) :
-    pack(inPack),
-    name(inName),
+private:
+  // the names below are cached in `m_qualifiedName` and `m_typePath`, so they're only changed through their setters
+  const FHaxePackage *m_package;
+  FString m_name;
+  FString m_haxeModule;
+  const FString *m_qualifiedName;
+  const FString *m_typePath;
+
+  void updateNames() {
+    if (m_package->pack.Num() == 0) {
+      m_typePath = m_qualifiedName = &FHaxeNamePool::intern(m_name);
+      return;
+    }
+
+    m_typePath = &FHaxeNamePool::intern(m_package->name + TEXT(".") + m_name);
+    if (m_haxeModule.IsEmpty()) {
+      m_qualifiedName = m_typePath;
+    } else {
+      m_qualifiedName = &FHaxeNamePool::intern(m_package->name + TEXT(".") + m_haxeModule + TEXT(".") + m_name);
+    }
+  }
+
+public:
+  FHaxeTypeRef(const FHaxePackage& inPackage, const FString inName, ETypeKind inKind, const FString inModule) :
     uname(inName),
     haxeGenerated(false),
     kind(inKind),
-    module(inModule)
+    module(inModule),
+    m_package(&inPackage),
+    m_name(inName)
   {
+    updateNames();
   }
 
   FHaxeTypeRef(const FString inName, ETypeKind inKind) :
-    name(inName),
     uname(inName),
     haxeGenerated(false),
     kind(inKind),
-    module(FString())
+    module(FString()),
+    m_package(&FHaxePackage::intern(TArray<FString>())),
+    m_name(inName)
   {
+    updateNames();
   }
 
-  FString toString() const {
-    if (this->pack.Num() == 0) {
-      return this->name;
-    }
+  const FString& getName() const {
+    return m_name;
+  }
 
-    if (this->haxeModule.IsEmpty()) {
-      return FString::Join(this->pack, TEXT(".")) + TEXT(".") + this->name;
-    } else {
-      return FString::Join(this->pack, TEXT(".")) + TEXT(".") + this->haxeModule + TEXT(".") + this->name;
-    }
+  void setName(const FString& inName) {
+    m_name = inName;
+    updateNames();
+  }
+
+  /**
+   * The Haxe module this type is declared in, or an empty string if it has its own module
+   **/
+  const FString& getHaxeModule() const {
+    return m_haxeModule;
+  }
+
+  void setHaxeModule(const FString& inHaxeModule) {
+    m_haxeModule = inHaxeModule;
+    updateNames();
+  }
+
+  const FHaxePackage *getPackage() const {
+    return m_package;
+  }
+
+  void setPack(const TArray<FString>& inPack) {
+    m_package = &FHaxePackage::intern(inPack);
+    updateNames();
+  }
+
+  const TArray<FString>& getPack() const {
+    return m_package->pack;
+  }
+
+  /**
+   * The fully qualified Haxe name of this type, including its Haxe module (if any)
+   **/
+  const FString& toString() const {
+    return *m_qualifiedName;
+  }
+
+  /**
+   * The Haxe package and name of this type, ignoring its Haxe module
+   **/
+  const FString& getTypePath() const {
+    return *m_typePath;
+  }
+
+  /**
+   * The Haxe package, separated by dots
+   **/
+  const FString& getPackageName() const {
+    return m_package->name;
+  }
+
+  /**
+   * The Haxe package, separated by slashes. This is the output directory of this type, relative to the externs root
+   **/
+  const FString& getPackagePath() const {
+    return m_package->path;
+  }
+};
+
+/**
+ * How the types of a UE package (i.e. a module) are mapped to Haxe. It's the same for all of them, so it's only
+ * computed once per package (see `HaxeTypeHelpers::getPackageInfo`)
+ **/
+struct FHaxePackageInfo {
+  const FHaxePackage *haxePackage;
+  // the name of the UE module, or empty for CoreUObject and Engine
+  FString module;
+  // what `FHaxeGeneratorConfig::shouldGenerateModule` decided for `module`, without and with the unreal types
+  bool generate;
+  bool generateWithUnreal;
+
+  bool shouldGenerate(bool inAlsoUnrealTypes) const {
+    return inAlsoUnrealTypes ? generateWithUnreal : generate;
   }
 };
 
@@ -65,44 +225,52 @@ struct HaxeTypeHelpers {
 
   static void replaceHaxeType(UField *inField, FHaxeTypeRef& outRef) {
     if (inField != nullptr) {
-      FString hxClass = inField->GetMetaData(TEXT("HaxeStaticClass"));
+      FString hxClass = inField->GetMetaData(FHaxeMetaKeys::get().HaxeStaticClass);
       if (!hxClass.IsEmpty()) {
         outRef.haxeGenerated = true;
         TArray<FString> fullName;
         hxClass.ParseIntoArray(fullName,TEXT("."),false);
-        outRef.name = fullName.Pop();
-        outRef.pack = fullName;
-
-        FString hxModule = inField->GetMetaData(TEXT("HaxeModule"));
+        outRef.setName(fullName.Pop());
+        FString hxModule = inField->GetMetaData(FHaxeMetaKeys::get().HaxeModule);
         if (!hxModule.IsEmpty()) {
-          outRef.haxeModule = hxModule;
+          outRef.setHaxeModule(hxModule);
         }
+        outRef.setPack(fullName);
       }
     }
   }
 
-  static const TArray<FString> getHaxePackage(UPackage *inPack, FString& outModule) {
+  /**
+   * Returns the Haxe package and module of `inPack`. Entries are never freed. Thread-safe
+   **/
+  static const FHaxePackageInfo& getPackageInfo(UPackage *inPack);
+
+  static const TArray<FString>& getHaxePackage(UPackage *inPack, FString& outModule) {
+    const FHaxePackageInfo& info = getPackageInfo(inPack);
+    outModule = info.module;
+    return info.haxePackage->pack;
+  }
+
+  /**
+   * Computes the Haxe package and module of `inPack`. Use `getPackageInfo` instead, which caches it
+   **/
+  static TArray<FString> resolveHaxePackage(UPackage *inPack, FString& outModule) {
     static const TCHAR *CoreUObject = TEXT("/Script/CoreUObject");
     static const TCHAR *Engine = TEXT("/Script/Engine");
     static const TCHAR *UnrealEd = TEXT("/Script/UnrealEd");
-    static bool isCompilingGameCode = compilingGameCode();
-    if (inPack->GetName() == CoreUObject || inPack->GetName() == Engine) {
-      static TArray<FString> ret;
-      if (ret.Num() == 0)
-        ret.Push(FString("unreal"));
+    FString name = inPack->GetName();
+    TArray<FString> ret;
+    if (name == CoreUObject || name == Engine) {
+      ret.Push(FString("unreal"));
       return ret;
-    } else if (inPack->GetName() == UnrealEd) {
-      static TArray<FString> ret;
-      if (ret.Num() == 0) {
-        ret.Push(FString("unreal"));
-        ret.Push(FString("editor"));
-      }
+    } else if (name == UnrealEd) {
+      ret.Push(FString("unreal"));
+      ret.Push(FString("editor"));
       outModule = FString(TEXT("UnrealEd"));
       return ret;
     }
-    outModule = inPack->GetName().RightChop( sizeof("/Script") );
-    TArray<FString> ret;
-    if (!isCompilingGameCode || !shouldGenerateModule(*outModule)) {
+    outModule = name.RightChop( sizeof("/Script") );
+    if (!compilingGameCode() || !shouldGenerateModule(*outModule)) {
       ret.Push("unreal");
     }
     ret.Push(outModule.ToLower());
@@ -110,51 +278,27 @@ struct HaxeTypeHelpers {
   }
 
   static bool shouldGenerateModule(const FString& name, bool alsoUnrealTypes=false) {
-    if (alsoUnrealTypes) {
-      static TArray<FString> unrealTargets(getUnrealTargetsToGenerate());
-      if (unrealTargets.Find(name) >= 0) {
-        return true;
-      }
-    }
-
-    static TArray<FString> targetsToGenerate(getTargetsToGenerate());
-    if (targetsToGenerate.Num() != 0 && targetsToGenerate.Find(name) < 0) {
-      return false;
-    }
-    return name != FString(TEXT("HaxeInit"));
+    return FHaxeGeneratorConfig::get().shouldGenerateModule(name, alsoUnrealTypes);
   }
 
   static bool compilingGameCode() {
-    static TArray<FString> targetsToGenerate(getTargetsToGenerate());
-    return (targetsToGenerate.Num() > 0);
+    return FHaxeGeneratorConfig::get().isCompilingGameCode();
   }
-
-private:
-  static TArray<FString> getTargetsToGenerate() {
-    FString env = FPlatformMisc::GetEnvironmentVariable(TEXT("EXTERN_MODULES"));
-    TArray<FString> ret;
-    env.ParseIntoArray(ret,TEXT(","),true);
-    return ret;
-  }
-
-  static TArray<FString> getUnrealTargetsToGenerate() {
-    FString env = FPlatformMisc::GetEnvironmentVariable(TEXT("UNREAL_EXTERN_MODULES"));
-    TArray<FString> ret;
-    env.ParseIntoArray(ret,TEXT(","),true);
-    return ret;
-  }
-
 };
 
 struct ClassDescriptor {
   UClass *uclass;
   FString header;
-  const FHaxeTypeRef haxeType;
+  // only changed by `FHaxeTypes::setHaxeModule`
+  FHaxeTypeRef haxeType;
+  // index in the FHaxeTypes type table
+  int32 id;
 
   ClassDescriptor(UClass *inUClass, const FString &inHeader) :
     uclass(inUClass),
     header(inHeader),
-    haxeType(getHaxeType(inUClass))
+    haxeType(getHaxeType(inUClass)),
+    id(INDEX_NONE)
   {
   }
 
@@ -166,13 +310,12 @@ private:
     if (isInterface) {
       prefix = TEXT("I");
     }
-    FString module;
-    auto haxePack = HaxeTypeHelpers::getHaxePackage(pack, module);
+    const FHaxePackageInfo& info = HaxeTypeHelpers::getPackageInfo(pack);
     FHaxeTypeRef ret(
-      haxePack,
+      *info.haxePackage,
       prefix + inUClass->GetName(),
       isInterface ? ETypeKind::KUInterface : ETypeKind::KUObject,
-      module);
+      info.module);
     HaxeTypeHelpers::replaceHaxeType(inUClass, ret);
     return ret;
   }
@@ -212,9 +355,12 @@ public:
 struct NonClassDescriptor {
   TSet<const ClassDescriptor *> sameModuleRefs;
   TSet<const ClassDescriptor *> otherModuleRefs;
-  const FHaxeTypeRef haxeType;
+  // only changed by `FHaxeTypes::setHaxeModule`
+  FHaxeTypeRef haxeType;
   const ModuleDescriptor *module;
   FString moduleSourcePath;
+  // index in the FHaxeTypes type table
+  int32 id;
 
   bool addRef(const ClassDescriptor *cls) {
     bool unused;
@@ -268,10 +414,11 @@ protected:
   NonClassDescriptor(FHaxeTypeRef inName, ModuleDescriptor *inModule, UField *inField) :
     haxeType(inName),
     module(inModule),
-    moduleSourcePath(inField->GetMetaData(TEXT("ModuleRelativePath")))
+    moduleSourcePath(inField->GetMetaData(FHaxeMetaKeys::get().ModuleRelativePath)),
+    id(INDEX_NONE)
   {
     if (moduleSourcePath.IsEmpty()) {
-      this->moduleSourcePath = inField->GetMetaData(TEXT("IncludePath"));
+      this->moduleSourcePath = inField->GetMetaData(FHaxeMetaKeys::get().IncludePath);
     }
   }
 };
@@ -302,17 +449,20 @@ private:
       }
     }
 
-    FString module;
-    auto newPack = TArray<FString>(HaxeTypeHelpers::getHaxePackage(pack, module));
+    const FHaxePackageInfo& info = HaxeTypeHelpers::getPackageInfo(pack);
     auto hxName = packArr.Pop( false );
-    for (auto& packPart : packArr) {
-      newPack.Push(packPart);
+    const FHaxePackage *haxePackage = info.haxePackage;
+    if (packArr.Num() > 0) {
+      // the namespaces of the enum are part of its package
+      TArray<FString> newPack = haxePackage->pack;
+      newPack.Append(packArr);
+      haxePackage = &FHaxePackage::intern(newPack);
     }
     FHaxeTypeRef ret(
-      newPack,
+      *haxePackage,
       hxName,
       ETypeKind::KUEnum,
-      module);
+      info.module);
     HaxeTypeHelpers::replaceHaxeType(inEnum, ret);
     return ret;
   }
@@ -330,13 +480,12 @@ struct StructDescriptor : public NonClassDescriptor {
 private:
   static FHaxeTypeRef getHaxeType(UStruct *inStruct) {
     auto pack = inStruct->GetOutermost();
-    FString module;
-    auto haxePack = HaxeTypeHelpers::getHaxePackage(pack, module);
+    const FHaxePackageInfo& info = HaxeTypeHelpers::getPackageInfo(pack);
     FHaxeTypeRef ret(
-      haxePack,
+      *info.haxePackage,
       inStruct->GetPrefixCPP() + inStruct->GetName(),
       ETypeKind::KUStruct,
-      module);
+      info.module);
     HaxeTypeHelpers::replaceHaxeType(inStruct, ret);
     return ret;
   }
@@ -354,44 +503,334 @@ struct DelegateDescriptor : public NonClassDescriptor {
 private:
   static FHaxeTypeRef getHaxeType(UFunction *inFunction) {
     auto pack = inFunction->GetOutermost();
-    FString module;
-    auto haxePack = HaxeTypeHelpers::getHaxePackage(pack, module);
+    const FHaxePackageInfo& info = HaxeTypeHelpers::getPackageInfo(pack);
     auto name = inFunction->GetName();
     if (!name.EndsWith(TEXT("__DelegateSignature"))) {
       UE_LOG(LogHaxeExtern, Fatal, TEXT("Bad delegate signature %s - it doesn't contain __DelegateSignature"), *name);
     }
     name = name.LeftChop(sizeof("__DelegateSignature") - 1);
     FHaxeTypeRef ret(
-      haxePack,
+      *info.haxePackage,
       inFunction->GetPrefixCPP() + name,
       ETypeKind::KUDelegate,
-      module);
+      info.module);
     HaxeTypeHelpers::replaceHaxeType(inFunction, ret);
     return ret;
   }
 };
 
+/**
+ * Owns objects of type `T`, allocated in contiguous blocks. The objects are never moved, and they are
+ * all released at once when the arena is destroyed
+ **/
+template<typename T, int32 BlockSize=256>
+class THaxeArena {
+private:
+  TArray<TTypeCompatibleBytes<T> *> m_blocks;
+  int32 m_lastBlockUsed;
+
+public:
+  THaxeArena() : m_lastBlockUsed(BlockSize)
+  {
+  }
+
+  THaxeArena(const THaxeArena&) = delete;
+  THaxeArena& operator=(const THaxeArena&) = delete;
+
+  ~THaxeArena() {
+    reset();
+  }
+
+  template<typename... ArgTypes>
+  T *create(ArgTypes&&... inArgs) {
+    if (m_lastBlockUsed == BlockSize) {
+      m_blocks.Push(new TTypeCompatibleBytes<T>[BlockSize]);
+      m_lastBlockUsed = 0;
+    }
+    return new (m_blocks.Last()[m_lastBlockUsed++].GetTypedPtr()) T(Forward<ArgTypes>(inArgs)...);
+  }
+
+  void reset() {
+    for (int32 i = 0; i < m_blocks.Num(); i++) {
+      int32 used = (i == m_blocks.Num() - 1) ? m_lastBlockUsed : BlockSize;
+      for (int32 j = 0; j < used; j++) {
+        m_blocks[i][j].GetTypedPtr()->~T();
+      }
+      delete[] m_blocks[i];
+    }
+    m_blocks.Reset();
+    m_lastBlockUsed = BlockSize;
+  }
+};
+
+/**
+ * An entry of the type table. Its index in the table is the `id` of its descriptor
+ **/
+struct FHaxeTypeEntry {
+  ETypeKind kind;
+  // false if this type must not be generated (e.g. a delegate that failed to generate)
+  bool exported;
+  // set when the type is added to the table
+  const FHaxePackageInfo *packageInfo;
+  union {
+    ClassDescriptor *cls;
+    StructDescriptor *ustruct;
+    EnumDescriptor *uenum;
+    DelegateDescriptor *udelegate;
+  };
+
+  FHaxeTypeEntry(ClassDescriptor *inDesc) : kind(inDesc->haxeType.kind), exported(true), packageInfo(nullptr), cls(inDesc)
+  {
+  }
+
+  FHaxeTypeEntry(StructDescriptor *inDesc) : kind(ETypeKind::KUStruct), exported(true), packageInfo(nullptr), ustruct(inDesc)
+  {
+  }
+
+  FHaxeTypeEntry(EnumDescriptor *inDesc) : kind(ETypeKind::KUEnum), exported(true), packageInfo(nullptr), uenum(inDesc)
+  {
+  }
+
+  FHaxeTypeEntry(DelegateDescriptor *inDesc) : kind(ETypeKind::KUDelegate), exported(true), packageInfo(nullptr), udelegate(inDesc)
+  {
+  }
+
+  bool isClass() const {
+    return kind == ETypeKind::KUObject || kind == ETypeKind::KUInterface;
+  }
+
+  /**
+   * Tells if the module of this type is generated. Same as `HaxeTypeHelpers::shouldGenerateModule`, but the decision
+   * was already made when the type was added, so it's cheap enough for the generation loops
+   **/
+  bool shouldGenerate(bool inAlsoUnrealTypes=false) const {
+    return packageInfo->shouldGenerate(inAlsoUnrealTypes);
+  }
+
+  const FHaxeTypeRef& getHaxeType() const {
+    switch (kind) {
+    case ETypeKind::KUStruct:
+      return ustruct->haxeType;
+    case ETypeKind::KUEnum:
+      return uenum->haxeType;
+    case ETypeKind::KUDelegate:
+      return udelegate->haxeType;
+    default:
+      return cls->haxeType;
+    }
+  }
+
+  FHaxeTypeRef& getHaxeType() {
+    return const_cast<FHaxeTypeRef&>(static_cast<const FHaxeTypeEntry *>(this)->getHaxeType());
+  }
+
+  /**
+   * The UE package (i.e. the module) where this type was declared
+   **/
+  UPackage *getPackage() const {
+    switch (kind) {
+    case ETypeKind::KUStruct:
+      return ustruct->module->getPackage();
+    case ETypeKind::KUEnum:
+      return uenum->module->getPackage();
+    case ETypeKind::KUDelegate:
+      return udelegate->module->getPackage();
+    default:
+      return cls->uclass->GetOuterUPackage();
+    }
+  }
+};
+
+/**
+ * A reference from the body of a struct or delegate (its super struct, properties and parameters)
+ * to a struct, enum or delegate
+ **/
+struct FHaxeTouchEdge {
+  UField *target;
+  ETypeKind kind;
+  // false if the reference may be forward declared, in which case it doesn't count as a reference from the class
+  bool withClass;
+
+  FHaxeTouchEdge(UField *inTarget, ETypeKind inKind, bool inWithClass) :
+    target(inTarget),
+    kind(inKind),
+    withClass(inWithClass)
+  {
+  }
+};
+
+/**
+ * A type that was touched on behalf of a class (or of no class at all)
+ **/
+struct FHaxeTouchKey {
+  const UField *type;
+  const ClassDescriptor *cls;
+
+  FHaxeTouchKey(const UField *inType, const ClassDescriptor *inClass) : type(inType), cls(inClass)
+  {
+  }
+
+  bool operator==(const FHaxeTouchKey& inOther) const {
+    return type == inOther.type && cls == inOther.cls;
+  }
+
+  friend uint32 GetTypeHash(const FHaxeTouchKey& inKey) {
+    return HashCombine(PointerHash(inKey.type), PointerHash(inKey.cls));
+  }
+};
+
 class FHaxeTypes {
 private:
-  TMap<FString, ClassDescriptor *> m_classes;
-  TMap<FString, EnumDescriptor *> m_enums;
-  TMap<FString, StructDescriptor *> m_structs;
-  TMap<FString, DelegateDescriptor *> m_delegates;
+  THaxeArena<ClassDescriptor> m_classArena;
+  THaxeArena<StructDescriptor> m_structArena;
+  THaxeArena<EnumDescriptor> m_enumArena;
+  THaxeArena<DelegateDescriptor> m_delegateArena;
+  THaxeArena<ModuleDescriptor, 32> m_moduleArena;
+
+  // all the types we know about, indexed by their id, in the order they were first touched
+  TArray<FHaxeTypeEntry> m_typeTable;
+
+  TMap<UClass *, ClassDescriptor *> m_classes;
+  TMap<UEnum *, EnumDescriptor *> m_enums;
+  TMap<UScriptStruct *, StructDescriptor *> m_structs;
+  TMap<UFunction *, DelegateDescriptor *> m_delegates;
 
   TMap<UPackage *, ModuleDescriptor *> m_upackageToModule;
 
+  // touching a type for a class always has the same effect, so each pair is only expanded once.
+  // The references found in the body of each struct and delegate are also kept, as they are the same for every class
+  TSet<FHaxeTouchKey> m_touched;
+  THaxeArena<TArray<FHaxeTouchEdge>> m_edgeArena;
+  TMap<UStruct *, const TArray<FHaxeTouchEdge> *> m_bodyEdges;
+
+  // the id of the first type that was added with each qualified Haxe name
+  TMap<const FString *, int32> m_qualifiedNames;
+
   const static FHaxeTypeRef nulltype;
 
   FString m_outPath;
 
-  void deleteFileIfExists(FHaxeTypeRef haxeType) {
-    auto outPath = this->m_outPath / FString::Join(haxeType.pack, TEXT("/")) / haxeType.name + TEXT(".hx");
+  void deleteFileIfExists(const FHaxeTypeRef& haxeType) {
+    auto outPath = this->m_outPath / haxeType.getPackagePath() / haxeType.getName() + TEXT(".hx");
     if (FPlatformFileManager::Get().GetPlatformFile().FileExists(*outPath)) {
       LOG("Deleting previously generated file %s", *outPath);
       FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*outPath);
     }
   }
 
+  template<typename T>
+  void addToTable(T *inDesc, bool inExported) {
+    inDesc->id = m_typeTable.Add(FHaxeTypeEntry(inDesc));
+    auto& entry = m_typeTable[inDesc->id];
+    entry.exported = inExported;
+    entry.packageInfo = &HaxeTypeHelpers::getPackageInfo(entry.getPackage());
+
+    // different UE modules may map to the same Haxe package (e.g. CoreUObject and Engine are both in `unreal`),
+    // so two types with the same name would be generated to the same file. The first one wins, and the others
+    // are never exported. Qualified names are interned
+    const FString *name = &inDesc->haxeType.toString();
+    int32 *found = m_qualifiedNames.Find(name);
+    if (found == nullptr) {
+      m_qualifiedNames.Add(name, inDesc->id);
+    } else {
+      UE_LOG(LogHaxeExtern, Warning, TEXT("Haxe type %s is declared by both %s and %s. Only the one from %s will be generated"),
+          **name, *m_typeTable[*found].getPackage()->GetName(), *entry.getPackage()->GetName(),
+          *m_typeTable[*found].getPackage()->GetName());
+      entry.exported = false;
+    }
+  }
+
+  /**
+   * Returns false if `inType` was already touched for `inClass`
+   **/
+  bool markTouched(const UField *inType, const ClassDescriptor *inClass) {
+    bool alreadyTouched = false;
+    m_touched.Add(FHaxeTouchKey(inType, inClass), &alreadyTouched);
+    return !alreadyTouched;
+  }
+
+  template<typename Allocator>
+  static void collectEdges(UProperty *inProp, bool inMayForward, TArray<FHaxeTouchEdge, Allocator>& outEdges) {
+    // see UnrealType.h for all possible variations
+    if (inProp->IsA<UStructProperty>()) {
+      auto structProp = Cast<UStructProperty>(inProp);
+      bool withClass = !inMayForward && !structProp->HasAnyPropertyFlags(CPF_ReturnParm | CPF_OutParm | CPF_ReferenceParm);
+      outEdges.Emplace(structProp->Struct, ETypeKind::KUStruct, withClass);
+    } else if (inProp->IsA<UNumericProperty>()) {
+      auto numeric = Cast<UNumericProperty>(inProp);
+      UEnum *uenum = numeric->GetIntPropertyEnum();
+      if (nullptr != uenum) {
+        // is enum
+        outEdges.Emplace(uenum, ETypeKind::KUEnum, true);
+      }
+    } else if (inProp->IsA<UEnumProperty>()) {
+      auto enumProp = Cast<UEnumProperty>(inProp);
+      UEnum *uenum = enumProp->GetEnum();
+      if (nullptr != uenum) {
+        // is enum
+        outEdges.Emplace(uenum, ETypeKind::KUEnum, true);
+      }
+    } else if (inProp->IsA<UArrayProperty>()) {
+      auto prop = Cast<UArrayProperty>(inProp);
+      collectEdges(prop->Inner, inMayForward, outEdges);
+    } else if (inProp->IsA<UMapProperty>()) {
+      auto prop = Cast<UMapProperty>(inProp);
+      collectEdges(prop->KeyProp, inMayForward, outEdges);
+      collectEdges(prop->ValueProp, inMayForward, outEdges);
+    } else if (inProp->IsA<USetProperty>()) {
+      auto prop = Cast<USetProperty>(inProp);
+      collectEdges(prop->ElementProp, inMayForward, outEdges);
+    } else if (inProp->IsA<UDelegateProperty>()) {
+      auto prop = Cast<UDelegateProperty>(inProp);
+      outEdges.Emplace(prop->SignatureFunction, ETypeKind::KUDelegate, true);
+    } else if (inProp->IsA<UMulticastDelegateProperty>()) {
+      auto prop = Cast<UMulticastDelegateProperty>(inProp);
+      outEdges.Emplace(prop->SignatureFunction, ETypeKind::KUDelegate, true);
+    }
+  }
+
+  /**
+   * The references made by the super struct and properties of a struct, or by the parameters of a delegate
+   **/
+  const TArray<FHaxeTouchEdge>& getBodyEdges(UStruct *inType) {
+    auto found = m_bodyEdges.FindRef(inType);
+    if (found != nullptr) {
+      return *found;
+    }
+    // the edges are never moved, so they can be iterated while new ones are added
+    auto edges = m_edgeArena.create();
+    if (UScriptStruct *super = Cast<UScriptStruct>(inType->GetSuperStruct())) {
+      // touching the direct super also touches the rest of the chain
+      edges->Emplace(super, ETypeKind::KUStruct, true);
+    }
+    TFieldIterator<UProperty> props(inType, EFieldIteratorFlags::ExcludeSuper);
+    for (; props; ++props) {
+      collectEdges(*props, false, *edges);
+    }
+    m_bodyEdges.Add(inType, edges);
+    return *edges;
+  }
+
+  template<typename Allocator>
+  void touchEdges(const TArray<FHaxeTouchEdge, Allocator>& inEdges, ClassDescriptor *inClass) {
+    for (const auto& edge : inEdges) {
+      auto cls = edge.withClass ? inClass : nullptr;
+      switch (edge.kind) {
+      case ETypeKind::KUStruct:
+        touchStruct(static_cast<UScriptStruct *>(edge.target), cls);
+        break;
+      case ETypeKind::KUEnum:
+        touchEnum(static_cast<UEnum *>(edge.target), cls);
+        break;
+      case ETypeKind::KUDelegate:
+        touchDelegate(static_cast<UFunction *>(edge.target), cls);
+        break;
+      default:
+        check(false);
+      }
+    }
+  }
+
 public:
   FHaxeTypes(FString inOutPath) : m_outPath(inOutPath)
   {
@@ -399,11 +838,18 @@ public:
 
   FHaxeTypes() {}
 
+  FHaxeTypes(const FHaxeTypes&) = delete;
+  FHaxeTypes& operator=(const FHaxeTypes&) = delete;
+
+  void setOutPath(const FString& inOutPath) {
+    m_outPath = inOutPath;
+  }
+
   void touchClass(UClass *inClass, const FString &inHeader, const FString &inModule) {
-    if (m_classes.Contains(inClass->GetName())) {
+    if (m_classes.Contains(inClass)) {
       return; // we've already touched this type; probably it's UObject which gets added every time (!)
     }
-    if (inClass->HasMetaData(TEXT("UHX_Internal"))) {
+    if (inClass->HasMetaData(FHaxeMetaKeys::get().UHX_Internal)) {
       // internal class, shouldn't be exported
       return;
     }
@@ -414,8 +860,9 @@ public:
     } else {
       header = inHeader;
     }
-    ClassDescriptor *cls = new ClassDescriptor(inClass, header);
-    m_classes.Add(inClass->GetName(), cls);
+    ClassDescriptor *cls = m_classArena.create(inClass, header);
+    m_classes.Add(inClass, cls);
+    addToTable(cls, true);
     LOG("Class name %s", *cls->haxeType.toString());
     auto module = getModule(inClass->GetOuterUPackage());
     module->touch(cls, inModule);
@@ -439,47 +886,19 @@ public:
   }
 
   ModuleDescriptor *getModule(UPackage *inPackage) {
-    if (m_upackageToModule.Contains(inPackage)) {
-      return m_upackageToModule[inPackage];
+    auto found = m_upackageToModule.FindRef(inPackage);
+    if (found != nullptr) {
+      return found;
     }
-    auto module = new ModuleDescriptor(inPackage);
+    auto module = m_moduleArena.create(inPackage);
     m_upackageToModule.Add(inPackage, module);
     return module;
   }
 
   void touchProperty(UProperty *inProp, ClassDescriptor *inClass, bool inMayForward) {
-    // see UnrealType.h for all possible variations
-    if (inProp->IsA<UStructProperty>()) {
-      auto structProp = Cast<UStructProperty>(inProp);
-      if (!inMayForward && !structProp->HasAnyPropertyFlags(CPF_ReturnParm | CPF_OutParm | CPF_ReferenceParm)) {
-        this->touchStruct(structProp->Struct, inClass);
-      } else {
-        this->touchStruct(structProp->Struct, nullptr);
-      }
-    } else if (inProp->IsA<UNumericProperty>()) {
-      auto numeric = Cast<UNumericProperty>(inProp);
-      UEnum *uenum = numeric->GetIntPropertyEnum();
-      if (nullptr != uenum) {
-        // is enum
-        this->touchEnum(uenum, inClass);
-      }
-    } else if (inProp->IsA<UEnumProperty>()) {
-      auto enumProp = Cast<UEnumProperty>(inProp);
-      UEnum *uenum = enumProp->GetEnum();
-      if (nullptr != uenum) {
-        // is enum
-        this->touchEnum(uenum, inClass);
-      }
-    } else if (inProp->IsA<UArrayProperty>()) {
-      auto prop = Cast<UArrayProperty>(inProp);
-      touchProperty(prop->Inner, inClass, inMayForward);
-    } else if (inProp->IsA<UDelegateProperty>()) {
-      auto prop = Cast<UDelegateProperty>(inProp);
-      touchDelegate(prop->SignatureFunction, inClass);
-    } else if (inProp->IsA<UMulticastDelegateProperty>()) {
-      auto prop = Cast<UMulticastDelegateProperty>(inProp);
-      touchDelegate(prop->SignatureFunction, inClass);
-    }
+    TArray<FHaxeTouchEdge, TInlineAllocator<2>> edges;
+    collectEdges(inProp, inMayForward, edges);
+    touchEdges(edges, inClass);
   }
 
   /**
@@ -490,31 +909,23 @@ public:
    * that has included its entire definition
    **/
   void touchStruct(UScriptStruct *inStruct, ClassDescriptor *inClass) {
-    if (inStruct->HasMetaData(TEXT("UHX_Internal"))) {
+    if (!markTouched(inStruct, inClass)) {
+      return;
+    }
+    if (inStruct->HasMetaData(FHaxeMetaKeys::get().UHX_Internal)) {
       // internal class, shouldn't be exported
       return;
     }
-    auto name = inStruct->GetName();
-    if (!m_structs.Contains(name)) {
-      m_structs.Add(name, new StructDescriptor(inStruct, this->getModule(inStruct->GetOutermost())));
+    auto descr = m_structs.FindRef(inStruct);
+    if (descr == nullptr) {
+      descr = m_structArena.create(inStruct, this->getModule(inStruct->GetOutermost()));
+      m_structs.Add(inStruct, descr);
+      addToTable(descr, !isBadType(inStruct));
     }
-    auto descr = m_structs[name];
     if (inClass != nullptr)
       descr->addRef(inClass);
 
-    auto super = inStruct->GetSuperStruct();
-    while (super != nullptr) {
-      if (super->IsA<UScriptStruct>()) {
-        this->touchStruct(Cast<UScriptStruct>(super), inClass);
-      }
-      super = super->GetSuperStruct();
-    }
-
-    TFieldIterator<UProperty> props(inStruct, EFieldIteratorFlags::ExcludeSuper);
-    for (; props; ++props) {
-      UProperty *prop = *props;
-      touchProperty(prop, inClass, false);
-    }
+    touchEdges(getBodyEdges(inStruct), inClass);
   }
 
   /**
@@ -522,15 +933,18 @@ public:
    * @see `touchStruct`
    **/
   void touchEnum(UEnum *inEnum, ClassDescriptor *inClass) {
-    if (inEnum->HasMetaData(TEXT("UHX_Internal"))) {
+    // `UEnum` hides the `FName` overloads of `HasMetaData`, so its metadata is looked up in its map directly
+    auto enumMeta = UMetaData::GetMapForObject(inEnum);
+    if (enumMeta != nullptr && enumMeta->Contains(FHaxeMetaKeys::get().UHX_Internal)) {
       // internal class, shouldn't be exported
       return;
     }
-    auto name = inEnum->GetName();
-    if (!m_enums.Contains(name)) {
-      m_enums.Add(name, new EnumDescriptor(inEnum, this->getModule(inEnum->GetOutermost())));
+    auto descr = m_enums.FindRef(inEnum);
+    if (descr == nullptr) {
+      descr = m_enumArena.create(inEnum, this->getModule(inEnum->GetOutermost()));
+      m_enums.Add(inEnum, descr);
+      addToTable(descr, true);
     }
-    auto descr = m_enums[name];
     LOG("Haxe enum name: %s", *descr->haxeType.toString());
     if (inClass != nullptr)
       descr->addRef(inClass);
@@ -544,7 +958,10 @@ public:
    * that has included its entire definition
    **/
   void touchDelegate(UFunction *inDelegate, ClassDescriptor *inClass) {
-    if (inDelegate->HasMetaData(TEXT("UHX_Internal"))) {
+    if (!markTouched(inDelegate, inClass)) {
+      return;
+    }
+    if (inDelegate->HasMetaData(FHaxeMetaKeys::get().UHX_Internal)) {
       // internal class, shouldn't be exported
       return;
     }
@@ -557,113 +974,103 @@ public:
       UE_LOG(LogHaxeExtern, Warning, TEXT("Delegate %s's name doesn't contain __DelegateSignature"), *name);
       return;
     }
-    if (!m_delegates.Contains(name)) {
-      m_delegates.Add(name, new DelegateDescriptor(inDelegate, this->getModule(inDelegate->GetOutermost())));
+    auto descr = m_delegates.FindRef(inDelegate);
+    if (descr == nullptr) {
+      descr = m_delegateArena.create(inDelegate, this->getModule(inDelegate->GetOutermost()));
+      m_delegates.Add(inDelegate, descr);
+      addToTable(descr, !isBadType(inDelegate));
     }
-    auto descr = m_delegates[name];
     if (inClass != nullptr) {
       descr->addRef(inClass);
     }
 
-    TFieldIterator<UProperty> props(inDelegate, EFieldIteratorFlags::ExcludeSuper);
-    for (; props; ++props) {
-      UProperty *prop = *props;
-      touchProperty(prop, inClass, false);
-    }
+    touchEdges(getBodyEdges(inDelegate), inClass);
   }
 
+  /**
+   * Stops exporting the types for which `inIsGenerated` is true, but that can't be reached from the classes
+   * for which `inIsRoot` is true. Types are reached through the same references that are followed by the touch phase,
+   * and classes also reach their super class, interfaces and the classes of their object properties.
+   * Only the references of generated types are followed, so the other types are the leaves of the traversal.
+   * Must be called once the touch phase is over. Returns how many types stopped being exported
+   **/
+  int32 exportOnlyReachable(TFunctionRef<bool (const FHaxeTypeEntry&)> inIsRoot, TFunctionRef<bool (const FHaxeTypeEntry&)> inIsGenerated);
+
+  /**
+   * Adds the ids of the types that `inEntry` uses directly to `outIds`: the structs, enums and delegates that
+   * the touch phase finds in its fields and parameters (including the elements of arrays, maps and sets), and for
+   * classes also their super class, interfaces and the classes of their object, class and soft class properties. Types that were never touched are left out, and an id may be added
+   * more than once. Must be called once the touch phase is over
+   **/
+  void getDependencies(const FHaxeTypeEntry& inEntry, TArray<int32>& outIds);
+
   ///////////////////////////////////////////////////////
   // Haxe Type handling
+  // Everything below (except for `setHaxeModule` and `doNotExportDelegate`) is read-only, and may be called
+  // concurrently once the touch phase is over
   ///////////////////////////////////////////////////////
 
-  const FHaxeTypeRef& toHaxeType(UClass *inClass) {
-    FString name = inClass->GetName();
-    if (!m_classes.Contains(name)) {
+  const FHaxeTypeRef& toHaxeType(UClass *inClass) const {
+    auto cls = m_classes.FindRef(inClass);
+    if (cls == nullptr) {
       return nulltype;
     }
-
-    auto cls = m_classes[name];
     return cls->haxeType;
   }
 
-  const FHaxeTypeRef& toHaxeType(UEnum *inEnum) {
-    FString name = inEnum->GetName();
-    if (!m_enums.Contains(name)) {
+  const FHaxeTypeRef& toHaxeType(UEnum *inEnum) const {
+    auto e = m_enums.FindRef(inEnum);
+    if (e == nullptr) {
       return nulltype;
     }
-
-    auto e = m_enums[name];
     return e->haxeType;
   }
 
-  static bool isBadType(const FString& inTypeName) {
-    static const FString materialInput = TEXT("MaterialInput");
-    return inTypeName == materialInput;
+  static bool isBadType(const UField *inField) {
+    static const FName materialInput = TEXT("MaterialInput");
+    return inField->GetFName() == materialInput;
   }
 
-  const FHaxeTypeRef& toHaxeType(UScriptStruct *inStruct) {
-    FString name = inStruct->GetName();
+  const FHaxeTypeRef& toHaxeType(UScriptStruct *inStruct) const {
     // deal with some types that can't be generated
-    if (isBadType(name)) {
+    if (isBadType(inStruct)) {
       return nulltype;
     }
 
-    if (!m_structs.Contains(name)) {
+    auto s = m_structs.FindRef(inStruct);
+    if (s == nullptr) {
       return nulltype;
     }
-
-    auto s = m_structs[name];
     return s->haxeType;
   }
 
-  const ClassDescriptor *getDescriptor(UClass *inClass) {
+  const ClassDescriptor *getDescriptor(UClass *inClass) const {
     if (inClass == nullptr) return nullptr;
-    FString name = inClass->GetName();
-    if (!m_classes.Contains(name)) {
-      return nullptr;
-    }
-
-    return m_classes[name];
+    return m_classes.FindRef(inClass);
   }
 
-  const EnumDescriptor *getDescriptor(UEnum *inEnum) {
+  const EnumDescriptor *getDescriptor(UEnum *inEnum) const {
     if (inEnum == nullptr) return nullptr;
-    FString name = inEnum->GetName();
-    if (!m_enums.Contains(name)) {
-      return nullptr;
-    }
-
-    return m_enums[name];
+    return m_enums.FindRef(inEnum);
   }
 
-  const StructDescriptor *getDescriptor(UScriptStruct *inStruct) {
+  const StructDescriptor *getDescriptor(UScriptStruct *inStruct) const {
     if (inStruct == nullptr) return nullptr;
-    FString name = inStruct->GetName();
-    if (isBadType(name)) {
+    if (isBadType(inStruct)) {
       return nullptr;
     }
-
-    if (!m_structs.Contains(name)) {
-      return nullptr;
-    }
-
-    return m_structs[name];
+    return m_structs.FindRef(inStruct);
   }
 
-  const DelegateDescriptor *getDescriptor(UFunction *inFunction) {
+  const DelegateDescriptor *getDescriptor(UFunction *inFunction) const {
     if (inFunction == nullptr) return nullptr;
-    FString name = inFunction->GetName();
-    if (isBadType(name)) {
-      return nullptr;
-    }
-    if (!m_delegates.Contains(name)) {
+    if (isBadType(inFunction)) {
       return nullptr;
     }
-
-    return m_delegates[name];
+    return m_delegates.FindRef(inFunction);
   }
 
-  TArray<const ModuleDescriptor *> getAllModules() {
+  TArray<const ModuleDescriptor *> getAllModules() const {
     TArray<const ModuleDescriptor *> ret;
     for (auto& elem : m_upackageToModule) {
       ret.Add(elem.Value);
@@ -671,59 +1078,68 @@ public:
     return ret;
   }
 
-  TArray<const ClassDescriptor *> getAllClasses() {
+  /**
+   * The number of entries in the type table. Valid ids go from 0 to `getNumTypes() - 1`
+   **/
+  int32 getNumTypes() const {
+    return m_typeTable.Num();
+  }
+
+  const FHaxeTypeEntry& getType(int32 inId) const {
+    return m_typeTable[inId];
+  }
+
+  TArray<const ClassDescriptor *> getAllClasses() const {
     TArray<const ClassDescriptor *> ret;
-    for (auto& elem : m_classes) {
-      ret.Add(elem.Value);
+    for (auto& entry : m_typeTable) {
+      if (entry.exported && entry.isClass()) {
+        ret.Add(entry.cls);
+      }
     }
     return ret;
   }
 
-  TArray<const EnumDescriptor *> getAllEnums() {
+  TArray<const EnumDescriptor *> getAllEnums() const {
     TArray<const EnumDescriptor *> ret;
-    for (auto& elem : m_enums) {
-      ret.Add(elem.Value);
+    for (auto& entry : m_typeTable) {
+      if (entry.exported && entry.kind == ETypeKind::KUEnum) {
+        ret.Add(entry.uenum);
+      }
     }
     return ret;
   }
 
-  TArray<const StructDescriptor *> getAllStructs() {
+  TArray<const StructDescriptor *> getAllStructs() const {
     TArray<const StructDescriptor *> ret;
-    for (auto& elem : m_structs) {
-      if (!isBadType(elem.Key)) {
-        ret.Add(elem.Value);
+    for (auto& entry : m_typeTable) {
+      if (entry.exported && entry.kind == ETypeKind::KUStruct) {
+        ret.Add(entry.ustruct);
       }
     }
     return ret;
   }
 
-  TArray<const DelegateDescriptor *> getAllDelegates() {
+  TArray<const DelegateDescriptor *> getAllDelegates() const {
     TArray<const DelegateDescriptor *> ret;
-    for (auto& elem : m_delegates) {
-      if (!isBadType(elem.Key)) {
-        ret.Add(elem.Value);
+    for (auto& entry : m_typeTable) {
+      if (entry.exported && entry.kind == ETypeKind::KUDelegate) {
+        ret.Add(entry.udelegate);
       }
     }
     return ret;
   }
 
-  void doNotExportDelegate(const DelegateDescriptor *inDelegate) {
-    m_delegates.Remove(inDelegate->delegateSignature->GetName());
-    delete inDelegate;
+  /**
+   * Moves the type `inId` into the Haxe module `inHaxeModule`, in the same package.
+   * Must be called before any type is generated, since other types reference it by its full name
+   **/
+  void setHaxeModule(int32 inId, const FString& inHaxeModule) {
+    m_typeTable[inId].getHaxeType().setHaxeModule(inHaxeModule);
   }
 
-  ~FHaxeTypes() {
-    for (auto& elem : m_enums) {
-      delete elem.Value;
-    }
-    for (auto& elem : m_structs) {
-      delete elem.Value;
-    }
-    for (auto& elem : m_classes) {
-      delete elem.Value;
-    }
-    for (auto& elem : m_upackageToModule) {
-      delete elem.Value;
-    }
+  void doNotExportDelegate(const DelegateDescriptor *inDelegate) {
+    m_delegates.Remove(inDelegate->delegateSignature);
+    // the descriptor itself is owned by the arena, and is only released with FHaxeTypes
+    m_typeTable[inDelegate->id].exported = false;
   }
 };
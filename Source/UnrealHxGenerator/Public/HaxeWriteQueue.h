@@ -0,0 +1,85 @@
+#pragma once
+#include <CoreMinimal.h>
+#include "HAL/CriticalSection.h"
+#include "HAL/Event.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Templates/Function.h"
+
+/**
+ * A file that must be written (or checked to be up-to-date) by the write queue
+ **/
+struct FHaxeWriteJob {
+  FString file;
+  // the UE module that generated the file (used for the stats)
+  FString module;
+  FString header;
+  FString contents;
+};
+
+/**
+ * A bounded write-behind queue: files are handed to background I/O workers, so the thread that generates them
+ * never waits on the file system - unless the queue is full.
+ * All jobs are run by the same `writer` function, which is called concurrently by the workers.
+ * If created without workers, the jobs are written right away by the thread that enqueues them
+ **/
+class FHaxeWriteQueue {
+public:
+  typedef TFunction<bool (FHaxeWriteJob& inJob, FString& outError)> FWriter;
+
+private:
+  class FWorker : public FRunnable {
+  private:
+    FHaxeWriteQueue& m_queue;
+
+  public:
+    FWorker(FHaxeWriteQueue& inQueue) : m_queue(inQueue)
+    {
+    }
+
+    virtual uint32 Run() override;
+  };
+
+  FWriter m_writer;
+  int32 m_numWorkers;
+
+  FCriticalSection m_lock;
+  // a ring buffer with `m_count` jobs starting at `m_head`
+  TArray<FHaxeWriteJob> m_jobs;
+  int32 m_head;
+  int32 m_count;
+  // jobs that were enqueued but didn't finish yet
+  int32 m_pending;
+  bool m_stopping;
+  bool m_failed;
+  FString m_error;
+
+  FEvent *m_workAvailable;
+  FEvent *m_spaceAvailable;
+  FEvent *m_idle;
+  TArray<FWorker *> m_workers;
+  TArray<FRunnableThread *> m_threads;
+
+  void startWorkers();
+  void stopWorkers();
+  bool pop(FHaxeWriteJob& outJob);
+  void finish(bool inSuccess, const FString& inError);
+
+public:
+  FHaxeWriteQueue(FWriter inWriter, int32 inNumWorkers, int32 inCapacity);
+  ~FHaxeWriteQueue();
+
+  FHaxeWriteQueue(const FHaxeWriteQueue&) = delete;
+  FHaxeWriteQueue& operator=(const FHaxeWriteQueue&) = delete;
+
+  /**
+   * Adds a job to the queue, waiting for a free slot if the queue is full
+   **/
+  void enqueue(FHaxeWriteJob&& inJob);
+
+  /**
+   * Waits until every enqueued job is done and stops the workers. Returns false if any of them failed,
+   * setting `outError` to the error of the first one that failed
+   **/
+  bool drain(FString& outError);
+};
@@ -1,5 +1,9 @@
 using System;
+using System.Collections.Generic;
 using System.IO;
+using System.Reflection;
+using System.Security.Cryptography;
+using System.Text;
 using UnrealBuildTool;
 
 public class UnrealHxGenerator : ModuleRules {
@@ -16,5 +20,39 @@ public class UnrealHxGenerator : ModuleRules {
         "CoreUObject",
       }
     );
+    PrivateDependencyModuleNames.AddRange(
+      new string[]
+      {
+        "Json",
+      }
+    );
+    // the generation cache must not be reused by a generator built from different sources
+    AddPrivateDefinition("UHX_GENERATOR_SOURCE_HASH=\"" + GetSourceHash() + "\"");
+  }
+
+  private void AddPrivateDefinition(string definition) {
+    // `Definitions` is deprecated since 4.19 in favor of `PrivateDefinitions`, which older engines don't have.
+    // Both are looked up by reflection, so that the rules compile without warnings on every engine version
+    FieldInfo field = GetType().GetField("PrivateDefinitions") ?? GetType().GetField("Definitions");
+    ((List<string>) field.GetValue(this)).Add(definition);
+  }
+
+  private string GetSourceHash() {
+    List<string> files = new List<string>();
+    foreach (string dir in new string[] { "Private", "Public" }) {
+      files.AddRange(Directory.GetFiles(Path.Combine(ModuleDirectory, dir), "*", SearchOption.AllDirectories));
+    }
+    // sorted, so the hash doesn't depend on the order the file system lists them
+    files.Sort(StringComparer.Ordinal);
+    using (SHA1 sha = SHA1.Create()) {
+      foreach (string file in files) {
+        byte[] name = Encoding.UTF8.GetBytes(file.Substring(ModuleDirectory.Length).Replace('\\', '/'));
+        byte[] contents = File.ReadAllBytes(file);
+        sha.TransformBlock(name, 0, name.Length, null, 0);
+        sha.TransformBlock(contents, 0, contents.Length, null, 0);
+      }
+      sha.TransformFinalBlock(new byte[0], 0, 0);
+      return BitConverter.ToString(sha.Hash).Replace("-", "");
+    }
   }
 }